@@ -5,7 +5,6 @@ target_include_directories(magique PUBLIC ${MAGIQUE_PUBLIC_INCLUDE} ${CMAKE_CURR
 target_include_directories(magique PRIVATE
         ${MAGIQUE_PUBLIC_INCLUDE} # Public includes
         ${MAGIQUE_PRIVATE_INCLUDE} # Private includes
-        ${MAGIQUE_CXSTRUCTS_INCLUDE} # cxstructs includes
 )
 
 # Compile the definition for the target and all consuming ones
@@ -672,6 +672,7 @@ namespace magique
     {
         CROSS, // Allows only orthogonal directions and cells (up left down right) - path will NOT contain diagonal moves
         STAR,  // Allows all orthogonal direction and additionally all diagonals top left, top right...
+        ANY,   // Same as STAR but the path only contains the corners - the straight lines between them are walkable
     };
 
     using PathFindHeuristicFunc = float (*)(const Point& curr, const Point& end);
@@ -2,6 +2,9 @@
 #ifndef MAGIQUE_ECS_H
 #define MAGIQUE_ECS_H
 
+#include <memory>
+#include <optional>
+#include <span>
 #include <magique/internal/entt/entity/registry.hpp>
 #include <magique/ecs/Components.h>
 #include <magique/core/Engine.h>
@@ -46,15 +49,35 @@ namespace magique
     // Failure: Returns NullEntity
     Entity EntityCreate(EntityType type, Point pos, MapID map, float rotation = 0, bool withFunc = true);
 
+    // Creates an entity for each position at once - much faster than creating them one by one
+    // The components are copied from a template captured once (per type) by calling the create function on a prototype
+    // The template is captured again after EntityRegister() - calls onCreate() and the create callback for each entity
+    // Note: The create function is called once more for the capture - on a prototype with the reserved id 0
+    //       The prototype is removed silently afterward (no onDestroy(), no destroy callback)
+    // Note: Only works if the create function just adds components (and changes them) - other effects are not repeated
+    //       The prototype is at (0, 0) on MapID{} - values that depend on the position or map are the same for all
+    //       Components emplaced with EntityGetRegistry() are not recorded - use ComponentGive()/ComponentTryGive()
+    //       Types are created one by one instead if the create function:
+    //          - creates a camera, gives non-copyable or unrecorded components
+    //          - creates other entities (destroyed again), makes it solid, a steer agent or adds it to the cache
+    // Failure: Returns an empty vector if the type is not registered
+    std::vector<Entity> EntityCreateBatch(EntityType type, std::span<const Point> positions, MapID map,
+                                          float rotation = 0);
+
     // Tries to create a new entity with the given id - will FAIL if this id is already taken
     // Note: Should only be called in a networking context with a valid id (when receiving entity info as a client)
-    // Note: You shouldn't use  this information - but entity ids start with 0 and go up until UINT32_MAX
+    // Note: You shouldn't use  this information - but entity ids start with 1 and go up until UINT32_MAX (0 is reserved)
     Entity EntityCreateEx(Entity id, EntityType type, Point pos, MapID map, float rotation, bool withFunc = true);
 
     // Sets a function that is called each time AFTER the entity is created or BEFORE the entity is destroyed
     void EntitySetCreateCallback(const EntityCallback& callback);
     void EntitySetDestroyCallback(const EntityCallback& callback);
 
+    // Moves the entity to the given position and map - it's drawn, updated and collided in its new area the next tick
+    // Note: Use this when moving entities far (teleports) - direct writes to PositionC that leave the areas around the
+    //       camera and actors are only noticed by a rolling check (up to 30 ticks) - in client mode each tick
+    void EntitySetPosition(Entity entity, Point pos, MapID map);
+
     // Returns true if the given entity exist in the registry
     bool EntityExists(Entity entity);
 
@@ -77,11 +100,24 @@ namespace magique
     // Failure: Returns NullEntity if none with that type could be found
     Entity EntityGetFirstOf(EntityType type);
 
+    // Returns all entities of the given type - only visits entities of that type
+    // Note: Invalidated when entities are created or destroyed - copy it if you do either while iterating
+    std::span<const Entity> EntityGetAllOf(EntityType type);
+
+    // Returns a view that iterates all entities of the given types - same rules as EntityGetAllOf()
+    //      for (const auto e : EntityGetViewOf({EntityType::ENEMY, EntityType::BOSS})) { ... }
+    struct EntityTypeView;
+    EntityTypeView EntityGetViewOf(std::initializer_list<EntityType> types);
+
     // Immediately tries to destroy this entity
     // Note: It's up to the user to make sure invalid entities are not accessed (destroying in event functions...)
     // Failure: Returns false if entity is invalid or doesn't exist
     bool EntityDestroy(Entity entity);
 
+    // Immediately destroys all given entities - all are notified (callback and onDestroy()) before any is destroyed
+    // Note: Much faster than destroying them one by one - invalid entities are skipped but each has to be unique
+    void EntityDestroy(std::span<const Entity> entities);
+
     // Immediately destroys all entities that have the given type - pass an empty list to destroy all types
     void EntityDestroy(const std::initializer_list<EntityType>& ids);
 
@@ -161,6 +197,150 @@ namespace magique
 
         void OnRemoveCollisionC(Entity e);
 
+        // A recorded structural change
+        struct ICommand
+        {
+            virtual ~ICommand() = default;
+            virtual void execute() = 0;
+        };
+
+        struct CommandBuffer;
+
+        // If set structural changes of this thread are recorded instead of executed (e.g. in parallel scripts)
+        inline thread_local CommandBuffer* COMMAND_BUFFER = nullptr;
+
+        // Records structural changes that are executed later in the recorded order
+        struct CommandBuffer final
+        {
+            std::vector<std::unique_ptr<ICommand>> commands;
+
+            template <typename Func>
+            void add(Func&& func)
+            {
+                struct FuncCommand final : ICommand
+                {
+                    std::decay_t<Func> func;
+                    explicit FuncCommand(Func&& func) : func(std::forward<Func>(func)) {}
+                    void execute() override { func(); }
+                };
+                commands.push_back(std::make_unique<FuncCommand>(std::forward<Func>(func)));
+            }
+
+            // Returns the recorded component - it can be modified until it's added
+            template <typename Component, bool isTry, typename... Args>
+            Component& give(const Entity entity, Args... args)
+            {
+                struct GiveCommand final : ICommand
+                {
+                    Component component;
+                    Entity entity;
+                    GiveCommand(const Entity entity, Component&& component) :
+                        component(std::move(component)), entity(entity)
+                    {
+                    }
+                    void execute() override
+                    {
+                        if (isTry && REGISTRY.all_of<Component>(entity))
+                            return;
+                        REGISTRY.emplace<Component>(entity, std::move(component));
+                    }
+                };
+                // Constructed the same way as the registry does it
+                if constexpr (std::is_aggregate_v<Component>)
+                    commands.push_back(std::make_unique<GiveCommand>(entity, Component{args...}));
+                else
+                    commands.push_back(std::make_unique<GiveCommand>(entity, Component(args...)));
+                return static_cast<GiveCommand&>(*commands.back()).component;
+            }
+
+            void execute()
+            {
+                MAGIQUE_ASSERT(COMMAND_BUFFER == nullptr, "Commands have to be executed outside the parallel phase");
+                for (const auto& command : commands)
+                {
+                    command->execute();
+                }
+                commands.clear();
+            }
+        };
+
+        // Sets the buffer of this thread and restores the previous one - a thread can pick up another chunk while
+        // it awaits inside a chunk
+        struct CommandBufferScope final
+        {
+            explicit CommandBufferScope(CommandBuffer* buffer) : previous(COMMAND_BUFFER) { COMMAND_BUFFER = buffer; }
+            ~CommandBufferScope() { COMMAND_BUFFER = previous; }
+            CommandBufferScope(const CommandBufferScope&) = delete;
+            CommandBufferScope& operator=(const CommandBufferScope&) = delete;
+
+        private:
+            CommandBuffer* previous;
+        };
+
+        // A component of an archetype template - copied to new entities
+        struct IArchetypeComponent
+        {
+            virtual ~IArchetypeComponent() = default;
+            // Copies the current value from the prototype - returns false if it doesn't have the component
+            virtual bool capture(Entity prototype) = 0;
+            virtual void apply(const Entity* first, const Entity* last) = 0;
+        };
+
+        // Records which components are given to the prototype while its create function is called
+        struct ArchetypeRecorder final
+        {
+            std::vector<std::unique_ptr<IArchetypeComponent>> components;
+            std::vector<Entity> children; // Entities created in the create function
+            Entity prototype = entt::null;
+            bool isCopyable = true; // False if any component can't be copied
+
+            template <typename Component>
+            void record(const Entity entity)
+            {
+                if (entity != prototype) // e.g. entities created in the create function
+                    return;
+                if constexpr (std::is_empty_v<Component>)
+                {
+                    struct TagComponent final : IArchetypeComponent
+                    {
+                        bool capture(const Entity prototype) override { return REGISTRY.all_of<Component>(prototype); }
+                        void apply(const Entity* first, const Entity* last) override
+                        {
+                            REGISTRY.insert<Component>(first, last);
+                        }
+                    };
+                    components.push_back(std::make_unique<TagComponent>());
+                }
+                else if constexpr (std::is_copy_constructible_v<Component>)
+                {
+                    struct ValueComponent final : IArchetypeComponent
+                    {
+                        std::optional<Component> value;
+                        bool capture(const Entity prototype) override
+                        {
+                            const auto* component = REGISTRY.try_get<Component>(prototype);
+                            if (component == nullptr)
+                                return false;
+                            value.emplace(*component);
+                            return true;
+                        }
+                        void apply(const Entity* first, const Entity* last) override
+                        {
+                            REGISTRY.insert<Component>(first, last, *value);
+                        }
+                    };
+                    components.push_back(std::make_unique<ValueComponent>());
+                }
+                else
+                {
+                    isCopyable = false;
+                }
+            }
+        };
+
+        // Set while an archetype template is captured - only on the main thread
+        inline ArchetypeRecorder* ARCHETYPE_RECORDER = nullptr;
+
     } // namespace internal
     inline entt::registry& EntityGetRegistry() { return internal::REGISTRY; }
 
@@ -197,12 +377,24 @@ namespace magique
     template <class Component, typename... Args>
     Component& ComponentGive(Entity entity, Args... args)
     {
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]]
+            return internal::COMMAND_BUFFER->give<Component, false>(entity, args...);
+        if (internal::ARCHETYPE_RECORDER != nullptr) [[unlikely]]
+            internal::ARCHETYPE_RECORDER->record<Component>(entity);
         return internal::REGISTRY.emplace<Component>(entity, args...);
     }
 
     template <typename Component, typename... Args>
     Component& ComponentTryGive(Entity entity, Args... args)
     {
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]]
+        {
+            if (auto* component = internal::REGISTRY.try_get<Component>(entity))
+                return *component;
+            return internal::COMMAND_BUFFER->give<Component, true>(entity, args...);
+        }
+        if (internal::ARCHETYPE_RECORDER != nullptr && !EntityHasAll<Component>(entity)) [[unlikely]]
+            internal::ARCHETYPE_RECORDER->record<Component>(entity);
         return internal::REGISTRY.get_or_emplace<Component>(entity, args...);
     }
 
@@ -232,6 +424,11 @@ namespace magique
     template <typename... Args>
     void ComponentRemove(Entity entity)
     {
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]]
+        {
+            internal::COMMAND_BUFFER->add([entity] { ComponentRemove<Args...>(entity); });
+            return;
+        }
         internal::REGISTRY.remove<Args...>(entity);
         if constexpr (contains<CollisionC, Args...>::value)
         {
@@ -245,6 +442,57 @@ namespace magique
         return internal::REGISTRY.view<Args...>();
     }
 
+    struct EntityTypeView final
+    {
+        struct Iterator final
+        {
+            const std::span<const Entity>* current;
+            const std::span<const Entity>* last;
+            size_t index;
+
+            Entity operator*() const { return (*current)[index]; }
+
+            Iterator& operator++()
+            {
+                if (++index >= current->size())
+                {
+                    ++current;
+                    index = 0;
+                    skipEmpty();
+                }
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const { return current == other.current && index == other.index; }
+
+            void skipEmpty()
+            {
+                while (current != last && current->empty())
+                    ++current;
+            }
+        };
+
+        [[nodiscard]] Iterator begin() const
+        {
+            Iterator it{spans.data(), spans.data() + spans.size(), 0};
+            it.skipEmpty();
+            return it;
+        }
+
+        [[nodiscard]] Iterator end() const { return {spans.data() + spans.size(), spans.data() + spans.size(), 0}; }
+
+        // Returns the total amount of entities
+        [[nodiscard]] size_t size() const
+        {
+            size_t size = 0;
+            for (const auto& span : spans)
+                size += span.size();
+            return size;
+        }
+
+        std::vector<std::span<const Entity>> spans; // One per type
+    };
+
 } // namespace magique
 
 #endif // MAGIQUE_ECS_H
@@ -2,6 +2,7 @@
 #ifndef MAGIQUE_INTERNAL_SCRIPTING_H
 #define MAGIQUE_INTERNAL_SCRIPTING_H
 
+#include <span>
 #include <magique/ecs/Components.h>
 
 //===============================================
@@ -26,6 +27,15 @@ namespace magique
     void ScriptingSetScript(EntityType type, EntityScript* script);
     void ScriptingSetScript(std::initializer_list<EntityType> types, EntityScript* script);
 
+    // Sets if onUpdate() (and onUpdateBatch()) of the script for this type is thread-safe - if true it's called in
+    // chunks of entities on the workers (and the main thread). Structural changes made in it are recorded and executed
+    // in a deterministic order after all chunks are done:
+    //      EntityCreate() (returns the already reserved id), EntityDestroy(), EntityDestroyDeferred(), ComponentGive(),
+    //      ComponentTryGive(), ComponentRemove() and ComponentGiveCollisionXXX()
+    // Note: Only modify the updated entity - other entities can be read but not written
+    // Default: false
+    void ScriptingSetParallel(EntityType type, bool value);
+
     // Retrieves the script for the entity type
     // Failure: if no script is registered for the given type returns nullptr
     // Note: By passing your custom derived class you can call new methods
@@ -58,6 +68,15 @@ namespace magique
         //      - updated: true if this entity is in update range of any actor (e.g. it's loaded)
         virtual void onUpdateEnd(Entity self, bool updated) {}
 
+        // Called once at the beginning of each tick with all scripted entities of a type this script is set for
+        // Per default calls onUpdate() for each entity - override it to process all entities in a tight loop
+        // Note: Use EngineIsCached(entity) to know if an entity is updated
+        virtual void onUpdateBatch(std::span<const Entity> entities);
+
+        // Called once after the update tick with all scripted entities of a type - same timing as onUpdateEnd()
+        // Per default calls onUpdateEnd() for each entity
+        virtual void onUpdateEndBatch(std::span<const Entity> entities);
+
         // Called each time this entity collides with another entity - called for both entities
         virtual void onDynamicCollision(Entity self, Entity other, CollisionInfo& collision)
         {
@@ -114,7 +114,7 @@ namespace magique
     //================= UTIL =================//
     enum LogLevel : int;
     struct JobData;
-    enum class JobID : uint16_t;
+    enum class JobID : uint32_t;
     struct IJob;
 
     //================= INTERNAL =================//
@@ -2,8 +2,10 @@
 #ifndef MAGIQUE_PATHFINDING_H
 #define MAGIQUE_PATHFINDING_H
 
+#include <span>
 #include <vector>
 #include <magique/core/Types.h>
+#include <magique/util/Datastructures.h>
 #include <raylib/raylib.h>
 
 //===============================================
@@ -12,6 +14,7 @@
 // .....................................................................
 // This module allows to find paths using the collision data static collision (see core/StaticCollision.h)
 // It uses A-Star and works by keeping a search grid of traversable tiles
+// Agents bigger than a single cell only get paths through gaps they fit in (see PathFindEx())
 // Note: The grid size is configured at compile time in magique/config.h
 // IMPORTANT: You probably don't need to get a new path each tick! It's probably enough to call it a couple of times per second
 //          => 30 times faster if you only do it 2 times per second instead of 60 (each tick) with almost same results
@@ -30,7 +33,7 @@ namespace magique
     // Same as PathFind() but allows to specify:
     //      - max: maximum length of the path
     //      - mode: allows to choose if diagonal steps are allowed
-    //      - hitbox: stops searching if the path length exceeds this
+    //      - hitbox: collision bounds of the agent - the path only passes cells where an agent of that size fits
     bool PathFindEx(std::vector<Point>& path, Point start, Point target, MapID map, int max = 50,
                     GridMode mode = GridMode::STAR, const Rect& hitbox = {});
 
@@ -43,6 +46,111 @@ namespace magique
     // Same as PathFind() but only assigns the next point
     bool PathFindNext(Point& next, Point start, Point end, MapID map, int maxLen = 50, GridMode mode = GridMode::STAR);
 
+    // Sets how many search results are cached - repeated searches between the same cells return the cached path
+    // Cached paths are discarded when the static grid is rebuilt or dynamic solid cells near the path changed
+    // Note: Searches with a custom heuristic function (PathFindPro()), PathFindNext() and PathFindRandomTarget() are
+    //       never cached
+    // Default: 0 (disabled)
+    void PathSetCacheSize(int entries);
+
+    //================= AGENT =================//
+
+    // Persistent path search for agents that repeatedly path to a target (e.g. an NPC chasing the player)
+    // Keeps its search state between calls and only repairs the affected parts when the agent moves or cells change
+    // Searches from scratch only when the target changes its cell, the map changes or the node budget ran out
+    // Note: Each agent needs its own instance - memory is bounded by maxNodes (cells kept in the search state)
+    struct PathAgent final
+    {
+        // Same parameters as PathFindEx()
+        explicit PathAgent(GridMode mode = GridMode::STAR, const Rect& hitbox = {},
+                           int maxNodes = MAGIQUE_MAX_PATH_SEARCH_CAPACITY);
+
+        // Updates the path from start to target - call this instead of PathFind() each time you need a new path
+        // Note: Will always try to return the best path even if it doesn't reach the target
+        // Returns: True if the path reaches the target
+        bool update(Point start, Point target, MapID map);
+
+        // Returns the current path - same as PathFind() in REVERSE order (last element is the next point)
+        const std::vector<Point>& getPath() const;
+
+        // Discards the search state - the next update() searches from scratch
+        void reset();
+
+    private:
+        M_MAKE_PUB()
+        struct Node final
+        {
+            float g;      // Cost to the goal
+            float rhs;    // One-step lookahead of g
+            bool blocked; // Solid state when last checked
+        };
+
+        struct Key final
+        {
+            float primary;
+            float secondary;
+            uint32_t cell;
+            bool operator>(const Key& o) const
+            {
+                return primary > o.primary || (primary == o.primary && secondary > o.secondary);
+            }
+        };
+
+        HashMap<uint32_t, Node> nodes;
+        HashMap<uint32_t, uint32_t> regions; // Regions of the nodes -> version when last checked
+        PriorityQueue<Key> open;
+        std::vector<Point> path;
+        std::vector<uint32_t> changedCells;
+        int maxNodes;
+        uint32_t start = 0;         // Cell of the agent - heuristics are relative to it
+        uint32_t goal = 0;          // Cell of the target - the search starts from it
+        uint32_t staticVersion = 0; // Version of the static grid the state is from
+        float keyOffset = 0.0F;     // Added to new keys - sum of the heuristic distances the agent moved
+        GridMode mode;
+        uint8_t clearance;
+        MapID map{};
+        bool isValid = false; // If the state can be reused
+        bool isFull = false;  // If the node budget was exhausted
+    };
+
+    //================= ASYNC =================//
+
+    // Handle to a queued path request
+    enum class PathRequestID : uint32_t
+    {
+        null = UINT32_MAX, // The null handle
+    };
+
+    enum class PathStatus : uint8_t
+    {
+        PENDING, // Still queued - poll again later
+        REACHED, // Finished - the path reaches the target
+        PARTIAL, // Finished - the path only gets as close as possible (or no random target was found)
+        INVALID, // Unknown, cancelled or already collected handle
+    };
+
+    // Queues a path search - same parameters as PathFindEx()
+    // Requests are processed in order at the end of each tick - limited by the budget (see PathSetRequestBudget())
+    // Use this for searches that are not urgent (e.g. wander targets) to avoid frame spikes from bursts of searches
+    PathRequestID PathFindAsync(Point start, Point target, MapID map, int max = 50, GridMode mode = GridMode::STAR,
+                                const Rect& hitbox = {});
+
+    // Same as PathFindRandomTarget() but queued - each tried position counts towards the budget separately
+    // Note: If found the polled path leads to the chosen position
+    PathRequestID PathFindRandomTargetAsync(Point start, const Rect& area, MapID map, int iterations = 50);
+
+    // Returns the status of the request - if it's finished the path (and the target) is assigned and the handle released
+    // Note: target is the requested target or the chosen random position (-1 if none was found)
+    PathStatus PathRequestPoll(PathRequestID id, std::vector<Point>& path, Point* target = nullptr);
+
+    // Cancels the request and releases the handle - does nothing if it's invalid
+    void PathRequestCancel(PathRequestID id);
+
+    // Sets how many cells can be evaluated each tick for queued requests - a single search is never split
+    // Note: At least one search is done each tick if a request is pending
+    // Default: 4 * MAGIQUE_MAX_PATH_SEARCH_CAPACITY
+    void PathSetRequestBudget(int nodesPerTick);
+
     //================= QUERY =================//
 
     // Returns true if the ray cast through the pathfinding grid does not hit solid cells (in line of sight)
@@ -54,6 +162,52 @@ namespace magique
     // Returns true if the pathfinding tile (that contains the point) is solid (cannot be walked on)
     bool PathIsSolid(const Point& pos, MapID map);
 
+    // Returns the distance in cells from the cell (that contains the point) to the closest solid cell
+    // Note: The value is capped at 8 - solid cells have a clearance of 0
+    int PathGetClearance(const Point& pos, MapID map);
+
+    //================= VISIBILITY =================//
+
+    // Cells visible from an observer within a radius - computed with shadowcasting over the pathfinding grid
+    // Solid cells are visible themselves but block the cells behind them
+    struct PathVisibility final
+    {
+        // Returns true if the cell that contains the given position is visible
+        [[nodiscard]] bool isVisible(const Point& pos) const;
+
+        // Returns the middle of the cell the visibility was computed from
+        [[nodiscard]] Point getOrigin() const;
+
+        // Returns the radius in cells
+        [[nodiscard]] int getRadius() const;
+
+    private:
+        M_MAKE_PUB()
+        std::vector<uint64_t> cells; // Bitmask of the (2 * radius + 1)^2 cells around the origin - row major
+        int originX = 0;             // Cell
+        int originY = 0;             // Cell
+        int radius = 0;              // In cells
+        uint32_t epoch = UINT32_MAX; // Tick it was computed in - cached results are valid for one tick
+        uint32_t staticVersion = 0;  // Static grid it was computed with
+        MapID map{};
+    };
+
+    // Computes the visibility from the given position - not cached
+    void PathComputeVisibility(PathVisibility& visibility, Point origin, MapID map, int radius);
+
+    // Returns the cells visible from the observers collision middle - cached until the next tick
+    // Note: Recomputed if called with a different radius in the same tick
+    // IMPORTANT: The returned reference is only valid until the next call
+    const PathVisibility& PathGetVisibility(Entity observer, int radius);
+
+    // Computes the visibility of many observers at once (distributed on the job system) - results are cached
+    // Call this before using PathGetVisibility() or PathCanSee() with the same radius for many observers
+    void PathComputeVisibility(std::span<const Entity> observers, int radius);
+
+    // Returns true IF both entities are on the same map AND the target's middle is visible from the observer
+    // Uses the cached visibility - much faster than PathRayCast() if an observer checks multiple targets
+    bool PathCanSee(Entity observer, Entity target, int radius);
+
     //================= UTIL =================//
 
     // Returns a randomly chosen movable position within the given area that can be reached from start
@@ -61,8 +215,8 @@ namespace magique
     Point PathFindRandomTarget(Point start, const Rect& area, MapID map, int iterations = 50);
 
     // Returns the next point on the path you should go to
-    // If inside a cell in the path returns the next logical cell you should move to
-    // Otherwise returns the target
+    // Follows the path segment closest to the given position and returns its end (or the next one if already there)
+    // If close to the target returns the target
     Point PathGetNextOnPath(const Point& pos, const Point& target, const std::vector<Point>& path);
 
     // If set, all entities of the given type are considered solid for pathfinding and make cells non-traversable
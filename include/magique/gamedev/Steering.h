@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#ifndef MAGIQUE_STEERING_H
+#define MAGIQUE_STEERING_H
+
+#include <magique/core/Types.h>
+
+//===============================================
+// Steering Module
+//===============================================
+// .....................................................................
+// Local avoidance for crowds - agents choose velocities that avoid each other instead of colliding (ORCA)
+// Each tick:
+//      1. Set the preferred velocity of each agent (e.g. towards the next point on its path)
+//      2. Call SteerCompute() - computes the adjusted velocities (distributed on the job system)
+//      3. Move the agents with their velocity from SteerGetVelocity()
+// Neighbours are found with the collision grid of the map - agents need the CollisionC
+// Entities with collision that are not agents are avoided as if they don't move
+// Note: Velocities are in world units per tick - the time horizon is in ticks
+// .....................................................................
+
+namespace magique
+{
+    //================= AGENTS =================//
+
+    // Adds the entity as steering agent - or updates its parameters if it already is one
+    //      - maxSpeed: maximum length of the adjusted velocity
+    //      - timeHorizon: how many ticks ahead collisions are avoided - higher is safer but less responsive
+    //      - radius: size of the agent - if 0 uses half the larger side of the collision bounds
+    // Note: Automatically removed when the entity is destroyed
+    void SteerAddAgent(Entity entity, float maxSpeed, float timeHorizon = 30.0F, float radius = 0.0F);
+
+    // Removes the entity from the steering agents - does nothing if it isn't one
+    void SteerRemoveAgent(Entity entity);
+
+    // Returns true if the entity is a steering agent
+    bool SteerIsAgent(Entity entity);
+
+    //================= VELOCITY =================//
+
+    // Sets the velocity the agent wants to move with - kept until changed
+    void SteerSetPreferred(Entity entity, Point velocity);
+
+    // Computes the adjusted velocities of all agents from their preferred velocities
+    // Call once per tick after setting the preferred velocities and before moving the agents
+    void SteerCompute();
+
+    // Returns the adjusted velocity of the agent from the last SteerCompute()
+    // Failure: Returns 0 if the entity is not an agent
+    Point SteerGetVelocity(Entity entity);
+
+} // namespace magique
+
+#endif // MAGIQUE_STEERING_H
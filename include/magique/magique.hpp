@@ -43,6 +43,7 @@
 #include "gamedev/PathFinding.h"
 #include "gamedev/Procedural.h"
 #include "gamedev/ShareCode.h"
+#include "gamedev/Steering.h"
 #include "gamedev/TextFormat.h"
 #include "gamedev/Tweens.h"
 #include "gamedev/VirtualClock.h"
@@ -93,6 +94,7 @@
 #include "util/Logging.h"
 #include "util/Strings.h"
 #include "util/JobSystem.h"
+#include "util/JobTask.h"
 #include "util/RayUtils.h"
 #include "util/Math.h"
 #include "util/Datastructures.h"
@@ -2,6 +2,7 @@
 #define NODO_DATASTRUCTURES_H
 
 #include <algorithm>
+#include <bit>
 #include <span>
 #include <magique/internal/ankerl/unordered_dense.h>
 #include <magique/util/Strings.h>
@@ -494,6 +495,105 @@ namespace magique
         Compare comp;
     };
 
+    // A radix heap - a priority queue for monotone keys (the smallest key is returned first)
+    // Monotone means a pushed key is never smaller than the last popped key - e.g. costs in Dijkstra or A*
+    // Push is O(1) and pop is amortized O(log(maxKey)) - much faster than PriorityQueue for large or many elements
+    // Float keys have to be quantized first (e.g. static_cast<uint32_t>(cost * 64))
+    // Note: Keys smaller than the last popped key are treated as equal to it - works for nearly monotone keys
+    // Note: Elements with equal keys are returned in no particular order
+    template <typename T, typename Key = uint32_t>
+    struct RadixHeap final
+    {
+        static_assert(std::is_unsigned_v<Key>, "Key must be an unsigned integer");
+
+        explicit RadixHeap(size_t len = 32) { buckets_[0].reserve(len); }
+
+        size_t size() const { return size_; }
+
+        // Adds an element with the given key
+        void push(const Key key, const T& e) noexcept { emplace(key, e); }
+
+        // Constructs a new T element with the given key
+        template <typename... Args>
+        void emplace(const Key key, Args&&... args) noexcept
+        {
+            const Key clamped = key < last_ ? last_ : key;
+            buckets_[GetBucket(clamped, last_)].emplace_back(clamped, T(std::forward<Args>(args)...));
+            ++size_;
+        }
+
+        // Removes the element with the smallest key
+        void pop() noexcept
+        {
+            MAGIQUE_ASSERT(size_ > 0, "no such element");
+            pull();
+            buckets_[0].pop_back();
+            --size_;
+        }
+
+        // Returns the element with the smallest key
+        T& top() noexcept
+        {
+            pull();
+            return buckets_[0].back().second;
+        }
+
+        // Returns the smallest key
+        Key topKey() noexcept
+        {
+            pull();
+            return buckets_[0].back().first;
+        }
+
+        // returns true if the heap is empty
+        bool empty() const { return size_ == 0; }
+
+        // Clears the heap of all elements and resets the monotone bound
+        void clear()
+        {
+            for (auto& bucket : buckets_)
+                bucket.clear();
+            last_ = 0;
+            size_ = 0;
+        }
+
+    private:
+        static constexpr int BUCKETS = (sizeof(Key) * 8) + 1;
+
+        // Elements that share their highest bits with the last key are in the lower buckets
+        static int GetBucket(const Key key, const Key last)
+        {
+            return static_cast<int>(std::bit_width(static_cast<Key>(key ^ last)));
+        }
+
+        // Moves the smallest elements into bucket 0
+        void pull() noexcept
+        {
+            MAGIQUE_ASSERT(size_ > 0, "no such element");
+            if (!buckets_[0].empty())
+                return;
+
+            int i = 1;
+            while (buckets_[i].empty())
+                ++i;
+
+            auto& bucket = buckets_[i];
+            Key newLast = bucket[0].first;
+            for (const auto& [key, e] : bucket)
+                newLast = key < newLast ? key : newLast;
+
+            // All elements go to a lower bucket relative to the new last key
+            for (auto& entry : bucket)
+                buckets_[GetBucket(entry.first, newLast)].push_back(std::move(entry));
+            bucket.clear();
+            last_ = newLast;
+        }
+
+        std::vector<std::pair<Key, T>> buckets_[BUCKETS];
+        Key last_ = 0;
+        size_t size_ = 0;
+    };
+
 
 } // namespace magique
 
@@ -2,27 +2,36 @@
 #ifndef MAGIQUE_JOBSYSTEM_H
 #define MAGIQUE_JOBSYSTEM_H
 
+#include <atomic>
 #include <functional>
 #include <span>
-#include <magique/fwd.hpp>
+#include <vector>
+#include <magique/core/Types.h>
 
 //===============================================
 // Job System
 //===============================================
 // .....................................................................
-// This system is trimmed for speed by busy waiting during the tick to quickly pickup tasks.
-// Between ticks, it's in hibernation, sleeping until woken up again (if not used).
+// This system is trimmed for speed by spinning shortly after each job to quickly pickup new tasks.
+// Idle workers then park (not using the CPU) until a job is added - between ticks they stay parked (hibernation).
 // Allows to submit concurrent jobs to distribute compatible work across threads and await their completion.
-// Per default has MAGIQUE_WORKER_THREADS many worker threads.
+// The amount of worker threads is set at runtime - per default one less than the hardware has (JobSetWorkerCount())
 // Note: Don't forget to give the main thread work as well BEFORE waiting for the jobs to return!
+//
+// Dependencies: Jobs can be added to only start after other jobs are done (JobAddAfter())
+// This allows to chain stages without blocking a thread in between - independent stages overlap
+// For work that is submitted every tick with the same structure use a JobGraph
+//
+// Main thread: Work that needs the main thread (e.g. GPU uploads) can be added from any thread (JobAddMainThread())
+// It's executed in the render tick by priority until the per-frame budget is used up - so it never causes hitches
 // .....................................................................
 
 namespace magique
 {
-    // Handle to a job
-    enum class JobID : uint16_t
+    // Handle to a job - awaiting a handle of a job that's already done returns immediately
+    enum class JobID : uint32_t
     {
-        null = UINT16_MAX, // The null handle
+        null = UINT32_MAX, // The null handle
     };
 
     // Adds a new job from the given callable or function
@@ -35,13 +44,125 @@ namespace magique
     template <typename Callable, typename... Args>
     JobID JobAddEx(Callable callable, Args... args);
 
-    // Waits till the specified jobs are completed
+    // Adds a new job that starts only after all the given jobs are done
+    // Note: Dependencies that are already done (or null) are ignored - the returned handle can be a dependency as well
+    template <typename Callable>
+    JobID JobAddAfter(std::span<const JobID> dependencies, Callable callable);
+
+    // Adds a new job that starts after the given job is done (continuation)
+    template <typename Callable>
+    JobID JobAddAfter(JobID dependency, Callable callable);
+
+    // Adds a new job that is executed on the main thread at the start of a render tick - can be called from any thread
+    // Jobs are executed by priority (then in order) until the frame budget is used up - the rest waits a frame
+    // Note: CRITICAL jobs are always executed in the next frame - use it for work that can't wait (ignores the budget)
+    // Note: Use it for everything that needs the graphics context (textures, shaders, atlas updates, ...)
+    template <typename Callable>
+    JobID JobAddMainThread(Callable callable, PriorityLevel priority = MEDIUM);
+
+    // Sets how much time main thread jobs can take each frame - at least 1 job is executed per frame
+    // Default: 2 ms
+    void JobSetMainThreadBudget(float millis);
+
+    // Waits till the specified jobs are completed - executes other queued jobs on the calling thread while waiting
+    // Note: This makes awaiting inside a job safe (nested parallelism) - the main thread also executes main thread jobs
+    //       if they are CRITICAL or awaited - others still wait for the render tick (don't await jobs that depend on them)
+    //       Other threads (e.g. asset loaders) only wait - they don't have a thread index of their own
     void JobAwait(JobID id);
     void JobAwait(std::span<const JobID> handles);
 
     // Waits until all jobs are done (e.g. none exists) - might never be true if new ones are added
     void JobAwaitAll();
 
+    //================= PARALLEL FOR =================//
+
+    // Calls func(thread, start, end) for chunks of [0, count) on the workers AND the calling thread - returns when done
+    //      - grainSize: minimal elements per chunk - chunks start big and get smaller towards the end (balances load)
+    //      - thread: index of the executing thread in [0, JobGetThreadCount()) - use it to index per-thread collectors
+    // Runs on the calling thread only if the count is not bigger than the grain size (or there are no workers)
+    // Note: A thread can execute multiple chunks - per-thread collectors have to be appended to, not overwritten
+    // Note: Only the main thread and the workers have a unique thread index - don't call it from other threads
+    template <typename Func>
+    void JobParallelFor(int count, int grainSize, Func&& func);
+
+    // Calls func(thread, chunk) for chunks of the span - same as above
+    template <typename T, typename Func>
+    void JobParallelFor(std::span<T> range, int grainSize, Func&& func);
+
+    // Returns the amount of threads that can execute parallel work (workers + main thread)
+    int JobGetThreadCount();
+
+    //================= WORKERS =================//
+
+    // Sets the amount of worker threads - has to be called before the game is created (takes effect on init)
+    //      - count: -1 uses one less than the hardware concurrency (for the main thread) - 0 runs all jobs on the main
+    //               thread each tick
+    //      - pinThreads: binds each worker (and the main thread) to its own core - helps on dedicated machines
+    // Default: MAGIQUE_WORKER_THREADS (-1 unless changed) without pinning
+    // Note: 0 threads is more efficient for the CPU and saves battery (preferred for mobile devices)
+    void JobSetWorkerCount(int count, bool pinThreads = false);
+
+    //================= STATS =================//
+
+    struct JobStats final
+    {
+        float spinMillis = 0.0F; // Time the workers spent spinning for new jobs (using the CPU)
+        float idleMillis = 0.0F; // Time the workers spent parked (not using the CPU)
+        int parks = 0;           // How often the workers parked
+    };
+
+    // Returns the summed stats of all workers since the last reset
+    JobStats JobGetStats();
+
+    // Resets the stats of all workers
+    void JobResetStats();
+
+    //================= JOB GRAPH =================//
+
+    // A reusable set of jobs and their dependencies - built once and run every tick
+    // Each node becomes a job on run() that starts as soon as the nodes it depends on are done
+    //      JobGraph graph;
+    //      const int particles = graph.add(UpdateParticles);
+    //      const int physics = graph.add(UpdatePhysics);
+    //      graph.add(UpdateSounds, {particles, physics}); // After both
+    //      ...
+    //      graph.run(); // Each tick
+    //      graph.await();
+    struct JobGraph final
+    {
+        // Adds a node to the graph - dependencies are the indices of previously added nodes
+        // Returns: the index of the new node
+        int add(const std::function<void()>& func, std::initializer_list<int> dependencies = {});
+
+        // Submits all nodes as jobs - nodes without dependencies start immediately
+        // Note: The graph must not be modified or run again before the last run is done
+        void run();
+
+        // Waits until all nodes of the last run are done
+        void await() const;
+
+        // Returns true if any node of the last run is not done yet
+        [[nodiscard]] bool isRunning() const;
+
+        // Removes all nodes
+        void clear();
+
+        // Returns the amount of nodes
+        [[nodiscard]] int getSize() const;
+
+    M_MAKE_PUB()
+        struct Node final
+        {
+            std::function<void()> func;
+            int depStart = 0; // Index into the dependency list
+            int depCount = 0;
+        };
+        std::vector<Node> nodes;
+        std::vector<int> dependencies;     // Node indices
+        std::vector<JobID> dependencyJobs; // Handles of the dependencies - same layout, reused by each run
+        std::vector<JobID> handles;        // Job handles of the last run
+    };
+
 } // namespace magique
 
 
@@ -63,10 +184,17 @@ namespace magique
         // Brings all workers back to speed (out of hibernate)
         void JobsWakeUp();
 
-        // Puts all workers to hibernation - pass the target until which to hibernate and the actual sleep time
-        void JobsSleep(double target, double sleepTime);
+        // Puts all workers to hibernation - they park until woken up again
+        void JobsSleep();
+
+        // Jobs (with their captures) up to this alignment are supported
+        static constexpr int JOB_ALIGNMENT = 16;
 
         JobID JobQueue(IJob* job, float delay = 0.0F);
+        JobID JobQueueAfter(IJob* job, std::span<const JobID> dependencies);
+        JobID JobQueueMainThread(IJob* job, PriorityLevel priority);
+        using ParallelFunc = void (*)(void* func, int thread, int start, int end);
+        void JobParallelForImpl(int count, int grainSize, ParallelFunc invoke, void* func);
         void* JobGetJobMemory(size_t bytes);
 
     } // namespace internal
@@ -78,6 +206,7 @@ namespace magique
         virtual void run() = 0;
         JobID id = JobID::null;
         float execTime = 0.0F;
+        std::atomic<int> waitCount = 0; // Dependencies that are not done yet
     };
 
     // Allows to explicitly specify parameters
@@ -106,6 +235,7 @@ namespace magique
     JobID JobAdd(Callable callable, float delay)
     {
         constexpr auto size = sizeof(Job<Callable>);
+        static_assert(alignof(Job<Callable>) <= internal::JOB_ALIGNMENT, "Over-aligned captures are not supported");
         void* ptr = internal::JobGetJobMemory(size);
         auto job = new (ptr) Job<Callable>(callable);
         return internal::JobQueue(job, delay);
@@ -115,11 +245,57 @@ namespace magique
     JobID JobAddEx(Callable callable, Args... args)
     {
         constexpr auto size = sizeof(ExplicitJob<Callable, Args...>);
+        static_assert(alignof(ExplicitJob<Callable, Args...>) <= internal::JOB_ALIGNMENT,
+                      "Over-aligned arguments are not supported");
         void* ptr = internal::JobGetJobMemory(size);
         auto job = new (ptr) ExplicitJob<Callable, Args...>(callable, args...);
         return internal::JobQueue(job);
     }
 
+    template <typename Callable>
+    JobID JobAddAfter(std::span<const JobID> dependencies, Callable callable)
+    {
+        constexpr auto size = sizeof(Job<Callable>);
+        static_assert(alignof(Job<Callable>) <= internal::JOB_ALIGNMENT, "Over-aligned captures are not supported");
+        void* ptr = internal::JobGetJobMemory(size);
+        auto job = new (ptr) Job<Callable>(callable);
+        return internal::JobQueueAfter(job, dependencies);
+    }
+
+    template <typename Callable>
+    JobID JobAddAfter(const JobID dependency, Callable callable)
+    {
+        return JobAddAfter(std::span<const JobID>{&dependency, 1}, std::move(callable));
+    }
+
+    template <typename Callable>
+    JobID JobAddMainThread(Callable callable, const PriorityLevel priority)
+    {
+        constexpr auto size = sizeof(Job<Callable>);
+        static_assert(alignof(Job<Callable>) <= internal::JOB_ALIGNMENT, "Over-aligned captures are not supported");
+        void* ptr = internal::JobGetJobMemory(size);
+        auto job = new (ptr) Job<Callable>(callable);
+        return internal::JobQueueMainThread(job, priority);
+    }
+
+    template <typename Func>
+    void JobParallelFor(const int count, const int grainSize, Func&& func)
+    {
+        // Wrapped so functions and callables can be passed the same way
+        auto call = [&func](const int thread, const int start, const int end) { func(thread, start, end); };
+        const auto invoke = [](void* ptr, const int thread, const int start, const int end)
+        { (*static_cast<decltype(call)*>(ptr))(thread, start, end); };
+        internal::JobParallelForImpl(count, grainSize, invoke, &call);
+    }
+
+    template <typename T, typename Func>
+    void JobParallelFor(std::span<T> range, const int grainSize, Func&& func)
+    {
+        const auto chunked = [&](const int thread, const int start, const int end)
+        { func(thread, range.subspan(start, end - start)); };
+        JobParallelFor(static_cast<int>(range.size()), grainSize, chunked);
+    }
+
 } // namespace magique
 
 #endif // MAGIQUE_JOBSYSTEM_H
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#ifndef MAGIQUE_JOBTASK_H
+#define MAGIQUE_JOBTASK_H
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <magique/util/JobSystem.h>
+
+//===============================================
+// Job Tasks (Coroutines)
+//===============================================
+// .....................................................................
+// Coroutines integrated with the job system - write loading pipelines and multi-tick sequences as sequential code
+// A task starts immediately on the calling thread and runs until it awaits:
+//      co_await JobWaitFor(id)          - resumes on a worker once the job is done (continues if it's already done)
+//      co_await JobSwitchToWorker()     - resumes on a worker (moves the work off the calling thread)
+//      co_await JobSwitchToMainThread() - resumes on the main thread at the start of the next frame (e.g. GPU uploads)
+//                                         continues directly if already on the main thread
+//      co_await JobNextTick()           - resumes on the main thread at the start of the next update tick
+// No thread is blocked while a task waits. Task frames are allocated from a pool.
+//
+//      JobTask LoadLevel(const char* path)
+//      {
+//          co_await JobSwitchToWorker();
+//          Image image = LoadImage(path);                  // On a worker
+//          co_await JobSwitchToMainThread();
+//          Texture texture = LoadTextureFromImage(image);  // On the main thread
+//          UnloadImage(image);
+//          co_await JobNextTick();                         // Spread work over multiple ticks
+//          ...
+//      }
+//      JobTask task = LoadLevel("level.png"); // Keep the task to check if it's done - or discard it to run detached
+//
+// Note: With 0 worker threads the worker parts run on the main thread each frame
+// .....................................................................
+
+namespace magique
+{
+    struct JobTask final
+    {
+        struct promise_type;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        JobTask() = default;
+        JobTask(const JobTask&) = delete;
+        JobTask& operator=(const JobTask&) = delete;
+        JobTask(JobTask&& other) noexcept;
+        JobTask& operator=(JobTask&& other) noexcept;
+        ~JobTask(); // Detaches the task - it keeps running
+
+        // Returns true if the coroutine ran to its end (or the task is empty)
+        [[nodiscard]] bool isDone() const;
+
+    M_MAKE_PUB()
+        explicit JobTask(Handle handle) : handle(handle) {}
+        Handle handle{};
+    };
+
+    // Resumes the awaiting task on a worker once the job is done - continues directly if it's already done
+    auto JobWaitFor(JobID id);
+
+    // Resumes the awaiting task on a worker - continues directly if already on a worker
+    auto JobSwitchToWorker();
+
+    // Resumes the awaiting task on the main thread at the start of the next frame - continues directly if on it
+    auto JobSwitchToMainThread();
+
+    // Resumes the awaiting task on the main thread at the start of the next update tick
+    auto JobNextTick();
+
+} // namespace magique
+
+
+//================= IMPLEMENTATION =================//
+
+
+namespace magique
+{
+    namespace internal
+    {
+        void* JobAllocateFrame(size_t bytes);
+        void JobFreeFrame(void* frame, size_t bytes);
+        bool JobIsMainThread();
+        bool JobIsWorkerThread();
+        bool JobIsPending(JobID id);
+        void JobResumeAfter(JobID id, std::coroutine_handle<> handle);
+        void JobResumeOnWorker(std::coroutine_handle<> handle);
+        void JobResumeOnMainThread(std::coroutine_handle<> handle);
+        void JobResumeNextTick(std::coroutine_handle<> handle);
+    } // namespace internal
+
+    struct JobTask::promise_type
+    {
+        std::atomic<int> references = 2; // The task object and the running coroutine
+        std::atomic<bool> isDone = false;
+
+        JobTask get_return_object() { return JobTask{Handle::from_promise(*this)}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        // Returns true if it was the last reference
+        bool release() noexcept { return references.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+        auto final_suspend() noexcept
+        {
+            struct FinalAwaiter final
+            {
+                bool await_ready() noexcept { return false; }
+                void await_suspend(const Handle handle) noexcept
+                {
+                    handle.promise().isDone.store(true, std::memory_order_release);
+                    if (handle.promise().release()) // Detached - nobody else destroys it
+                        handle.destroy();
+                }
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+
+        static void* operator new(const size_t bytes) { return internal::JobAllocateFrame(bytes); }
+        static void operator delete(void* frame, const size_t bytes) { internal::JobFreeFrame(frame, bytes); }
+    };
+
+    inline JobTask::JobTask(JobTask&& other) noexcept : handle(other.handle) { other.handle = {}; }
+
+    inline JobTask& JobTask::operator=(JobTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            this->~JobTask();
+            handle = other.handle;
+            other.handle = {};
+        }
+        return *this;
+    }
+
+    inline JobTask::~JobTask()
+    {
+        if (handle && handle.promise().release())
+            handle.destroy();
+        handle = {};
+    }
+
+    inline bool JobTask::isDone() const
+    {
+        return !handle || handle.promise().isDone.load(std::memory_order_acquire);
+    }
+
+    inline auto JobWaitFor(const JobID id)
+    {
+        struct JobAwaiter final
+        {
+            JobID id;
+            [[nodiscard]] bool await_ready() const { return !internal::JobIsPending(id); }
+            void await_suspend(const std::coroutine_handle<> handle) const { internal::JobResumeAfter(id, handle); }
+            void await_resume() const {}
+        };
+        return JobAwaiter{id};
+    }
+
+    inline auto JobSwitchToWorker()
+    {
+        struct WorkerAwaiter final
+        {
+            [[nodiscard]] bool await_ready() const { return internal::JobIsWorkerThread(); }
+            void await_suspend(const std::coroutine_handle<> handle) const { internal::JobResumeOnWorker(handle); }
+            void await_resume() const {}
+        };
+        return WorkerAwaiter{};
+    }
+
+    inline auto JobSwitchToMainThread()
+    {
+        struct MainThreadAwaiter final
+        {
+            [[nodiscard]] bool await_ready() const { return internal::JobIsMainThread(); }
+            void await_suspend(const std::coroutine_handle<> handle) const { internal::JobResumeOnMainThread(handle); }
+            void await_resume() const {}
+        };
+        return MainThreadAwaiter{};
+    }
+
+    inline auto JobNextTick()
+    {
+        struct NextTickAwaiter final
+        {
+            [[nodiscard]] bool await_ready() const { return false; }
+            void await_suspend(const std::coroutine_handle<> handle) const { internal::JobResumeNextTick(handle); }
+            void await_resume() const {}
+        };
+        return NextTickAwaiter{};
+    }
+
+} // namespace magique
+
+#endif // MAGIQUE_JOBTASK_H
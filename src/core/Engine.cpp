@@ -39,12 +39,18 @@ namespace magique
 
     void EngineAddToCache(const Entity e)
     {
-        global::ENGINE_DATA.entityUpdateCache[e] = global::ENGINE_CONFIG.entityCacheDuration;
+        auto& data = global::ENGINE_DATA;
+        // Counted from the next tick - the update vector of this tick is already built
+        data.entityUpdateCache.add(e, data.engineTicks + 1 + global::ENGINE_CONFIG.entityCacheDuration);
     }
 
     void EngineClearCache() { global::ENGINE_DATA.entityUpdateCache.clear(); }
 
-    bool EngineIsCached(Entity e) { return global::ENGINE_DATA.entityUpdateCache.contains(e); }
+    bool EngineIsCached(const Entity e)
+    {
+        const auto& data = global::ENGINE_DATA;
+        return data.entityUpdateCache.contains(e, data.engineTicks);
+    }
 
     void EngineEnableCollision(const bool value) { global::ENGINE_CONFIG.enableCollisionSystem = value; }
 
@@ -26,12 +26,14 @@
 #include "internal/globals/TextureAtlas.h"
 #include "internal/globals/AudioPlayer.h"
 #include "internal/globals/ScriptData.h"
+#include "internal/globals/ECSData.h"
 #include "internal/globals/UIData.h"
 #include "internal/globals/ConsoleData.h"
 #include "internal/globals/ParticleData.h"
 #include "internal/utils/CollisionSystemUtil.h"
 #include "internal/globals/StaticCollisionData.h"
 #include "internal/globals/DynamicCollisionData.h"
+#include "internal/globals/SteeringData.h"
 #include "internal/globals/LoggingData.h"
 #include "magique/graphics/Lighting.h"
 
@@ -93,6 +95,13 @@ namespace magique
             JobsInit();
             LightingInit();
 
+            // Per thread collectors - the thread count is only known after the job system is initialized
+            const int threadCount = JobGetThreadCount();
+            global::DY_COLL_DATA.collisionPairs.resize(threadCount);
+            global::STATIC_COLL_DATA.pairCollector.resize(threadCount);
+            global::STATIC_COLL_DATA.colliderCollector.resize(threadCount);
+            global::STEER_DATA.scratch.resize(threadCount);
+
             VignetteShader::Init();
             OutlineShader::Init();
 
@@ -111,7 +120,7 @@ namespace magique
 #endif
 
             LOG_INFO("Initialized magique %s (raylib %s; %d Workers; Steam %d; LAN: %d)", MAGIQUE_VERSION,
-                     RAYLIB_VERSION, MAGIQUE_WORKER_THREADS, steam, lan);
+                     RAYLIB_VERSION, threadCount - 1, steam, lan);
             return true;
         }
     } // namespace internal
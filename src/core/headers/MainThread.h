@@ -64,7 +64,7 @@ namespace magique::mainthread
                 const auto sleepTime = std::floor((config.sleepTime - nextFrameTime) * 1000) / 1000;
                 const auto target = GetTime() + (config.frameTarget - nextFrameTime); // How long we wait in total
 
-                internal::JobsSleep(target, sleepTime);
+                internal::JobsSleep();
                 WaitTime(target, sleepTime);
                 config.frameCounter++;
             }
@@ -18,6 +18,7 @@ namespace magique::renderer
     {
         AssignCameraPosition();
         ResetDrawCallCount();
+        global::SCHEDULER.runMainJobs(); // GPU work from other threads - within its time budget
         global::UI_DATA.onRenderTick();
     }
 
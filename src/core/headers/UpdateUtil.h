@@ -8,12 +8,23 @@ namespace magique
     inline void InternalUpdatePre(const entt::registry& registry, Game& game) // Before user space update
     {
         global::TWEEN_DATA.update();
-        global::CONSOLE_DATA.update();  // First in case needs to block input
-        global::PARTICLE_DATA.update(); // Order doesnt matter
-        global::ENGINE_DATA.update();
+        global::CONSOLE_DATA.update(); // First in case needs to block input
+        // The stages are not a JobGraph - nearly all of them call user code that can touch any engine state
+        // Only overlaps with engine code that never touches particles - awaited before any user code runs
+        // Scripts (LogicSystem), resumed tasks and callbacks can emit particles via ParticlesEmit()
+        auto particles = JobID::null;
+        if (JobGetThreadCount() > 1)
+            particles = JobAdd([] { global::PARTICLE_DATA.update(); });
+        else
+            global::PARTICLE_DATA.update();
+        global::ENGINE_DATA.update(); // Camera shake
+        JobAwait(particles);
 
         LogicSystem(registry); // Before gametick cause essential
 
+        auto& scheduler = global::SCHEDULER;
+        scheduler.resumeAll(scheduler.tickResumes); // Tasks waiting for this tick - after the entities are updated
+
         // Order doesnt matter
         auto& config = global::ENGINE_CONFIG;
         if (config.showPerformanceOverlay)
@@ -55,12 +66,18 @@ namespace magique
             DynamicCollisionSystem(); // After cause user systems can modify entity state
             ResolveCollisions();
         }
-        global::AUDIO_PLAYER.update(); // After game tick cause position updates
+        global::AUDIO_PLAYER.update();       // After game tick cause position updates
+        global::PATH_DATA.processRequests(); // After game tick so requests of this tick are already handled
         WindowManagerGet().update();
         auto& data = global::ENGINE_DATA;
-        for (auto e : data.deferredDestroyVec)
-            EntityDestroy(e);
-        data.deferredDestroyVec.clear();
+        if (!data.deferredDestroyVec.empty())
+        {
+            std::vector<Entity> destroyVec; // Swapped out - callbacks can defer new entities (destroyed next tick)
+            destroyVec.swap(data.deferredDestroyVec);
+            std::ranges::sort(destroyVec); // Entities can be added multiple times
+            destroyVec.erase(std::ranges::unique(destroyVec).begin(), destroyVec.end());
+            EntityDestroy(destroyVec);
+        }
     }
 } // namespace magique
 
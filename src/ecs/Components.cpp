@@ -211,10 +211,11 @@ namespace magique
 
     void CollisionC::CenterOn(Entity e, Point point)
     {
-        auto& pos = ComponentGet<PositionC>(e);
-        auto& col = ComponentGet<CollisionC>(e);
-        pos.pos = point - col.getMidOffset();
-        pos.pos.floor();
+        const auto& pos = ComponentGet<PositionC>(e);
+        const auto& col = ComponentGet<CollisionC>(e);
+        auto newPos = point - col.getMidOffset();
+        newPos.floor();
+        EntitySetPosition(e, newPos, pos.map);
     }
 
     Point CollisionC::GetMiddle(const Entity e)
@@ -1,4 +1,6 @@
 // SPDX-License-Identifier: zlib-acknowledgement
+#include <atomic>
+
 #include <raylib/raylib.h>
 
 #include <magique/core/Engine.h>
@@ -13,6 +15,7 @@
 #include "internal/globals/EngineConfig.h"
 #include "internal/globals/DynamicCollisionData.h"
 #include "internal/globals/PathFindingData.h"
+#include "internal/globals/SteeringData.h"
 #include "magique/networking/Networking.h"
 
 namespace magique
@@ -24,6 +27,7 @@ namespace magique
         if (map.contains(type))
             LOG_WARNING("Overriding existing create function for entity: %d (enum value)", static_cast<int>(type));
         map[type] = createFunc;
+        global::ECS_DATA.archetypes.erase(type); // Captured again with the new function
 
         // Iterates all entities
         for (auto entity : internal::REGISTRY.view<Entity>())
@@ -53,6 +57,7 @@ namespace magique
             return false; // Invalid ID or not registered
         }
         map.erase(type);
+        global::ECS_DATA.archetypes.erase(type);
         return true;
     }
 
@@ -64,15 +69,53 @@ namespace magique
 
     Entity EntityGetFirstOf(const EntityType type)
     {
-        for (const auto entity : internal::REGISTRY.view<Entity>())
+        const auto entities = global::ECS_DATA.typeIndex.get(type);
+        return entities.empty() ? entt::null : entities.front();
+    }
+
+    std::span<const Entity> EntityGetAllOf(const EntityType type) { return global::ECS_DATA.typeIndex.get(type); }
+
+    EntityTypeView EntityGetViewOf(const std::initializer_list<EntityType> types)
+    {
+        const auto& typeIndex = global::ECS_DATA.typeIndex;
+        EntityTypeView view;
+        view.spans.reserve(types.size());
+        for (const auto type : types)
         {
-            const auto& pos = internal::REGISTRY.get<const PositionC>(entity);
-            if (pos.type == type)
-            {
-                return entity;
-            }
+            view.spans.push_back(typeIndex.get(type));
         }
-        return entt::null;
+        return view;
+    }
+
+    static void NotifyDestroy(const Entity entity)
+    {
+        const auto& config = global::ENGINE_CONFIG;
+        const auto& data = global::ENGINE_DATA;
+
+        if (data.destroyCallback)
+            data.destroyCallback(entity);
+
+        if (!config.isClientMode && data.isEntityScripted(entity)) [[likely]]
+            internal::GetScriptInternal(entity)->onDestroy(entity);
+    }
+
+    // Removes the entity from all engine datastructures - each in O(1) (or the few grid cells it was inserted into)
+    static void RemoveEntityData(const Entity entity)
+    {
+        auto& data = global::ENGINE_DATA;
+        const auto& pos = internal::POSITION_GROUP.get<const PositionC>(entity);
+
+        data.entityUpdateCache.remove(entity);
+        data.removeFromTickVecs(entity);
+        data.entityNScriptedSet.erase(entity);
+        global::DY_COLL_DATA.removeEntity(entity, pos.map);
+        global::PATH_DATA.solidEntities.erase(entity);
+        global::PATH_DATA.visibilityCache.erase(entity);
+        global::STEER_DATA.agents.erase(entity);
+        data.regionIndex.remove(entity);
+        global::ECS_DATA.typeIndex.remove(entity);
+        if (entity == CameraGetEntity())
+            data.cameraEntity = entt::null;
     }
 
     static Entity CreateEntityInternal(const Entity id, EntityType type, const Point& pos, const MapID map,
@@ -86,6 +129,10 @@ namespace magique
 
         const auto entity = registry.create(id != entt::null ? id : Entity{ecs.entityID++});
         registry.emplace<PositionC>(entity, pos, map, type, rotation); // PositionC is default
+        data.regionIndex.insert(entity, pos, map);
+        ecs.typeIndex.insert(entity, type);
+        if (internal::ARCHETYPE_RECORDER != nullptr) [[unlikely]]
+            internal::ARCHETYPE_RECORDER->children.push_back(entity);
 
         if (withFunc) [[likely]]
         {
@@ -113,10 +160,22 @@ namespace magique
         return entity;
     }
 
+    // Reserves the id so it can be used in the following commands - the entity is created when they are executed
+    static Entity CreateEntityDeferred(Entity id, EntityType type, const Point& pos, const MapID map,
+                                       const float rotation, const bool withFunc)
+    {
+        if (id == entt::null)
+            id = Entity{std::atomic_ref{global::ECS_DATA.entityID}.fetch_add(1, std::memory_order_relaxed)};
+        internal::COMMAND_BUFFER->add([=] { CreateEntityInternal(id, type, pos, map, rotation, withFunc); });
+        return id;
+    }
+
     Entity EntityCreate(const EntityType type, Point pos, const MapID map, float rotation, const bool withFunc)
     {
         if (NetworkIsClientMode())
             LOG_WARNING("Created non-networked entity on the client");
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]]
+            return CreateEntityDeferred(entt::null, type, pos, map, rotation, withFunc);
         return CreateEntityInternal(entt::null, type, pos, map, rotation, withFunc);
     }
 
@@ -124,41 +183,212 @@ namespace magique
                           const bool withFunc)
     {
         MAGIQUE_ASSERT(!EntityExists(id), "Entity already exists!");
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]]
+            return CreateEntityDeferred(id, type, pos, map, rot, withFunc);
         return CreateEntityInternal(id, type, pos, map, rot, withFunc);
     }
 
-    void EntitySetDestroyCallback(const EntityCallback& callback) { global::ENGINE_DATA.destroyCallback = callback; }
+    // Calls the create function on a prototype and captures its components - the prototype is removed silently
+    // The prototype uses the reserved id so capturing doesn't change the ids of the created entities
+    // Always captured at the same position and map - the template is shared by all batches of the type
+    static Archetype CaptureArchetype(const EntityType type, const CreateFunc& createFunc)
+    {
+        auto& data = global::ENGINE_DATA;
+        auto& registry = internal::REGISTRY;
 
-    bool EntityDestroy(const Entity entity)
+        Archetype archetype;
+        internal::ArchetypeRecorder recorder;
+        auto* previous = internal::ARCHETYPE_RECORDER; // Create functions can batch create other types
+        const auto prototype = registry.create(ECSData::PROTOTYPE_ID); // Doesn't use up an id
+        registry.emplace<PositionC>(prototype, Point{}, MapID{}, type, 0.0F);
+        recorder.prototype = prototype;
+        internal::ARCHETYPE_RECORDER = &recorder;
+        createFunc(prototype, type);
+        internal::ARCHETYPE_RECORDER = previous;
+
+        for (auto& component : recorder.components)
+        {
+            if (component->capture(prototype)) // Could have been removed again
+                archetype.components.push_back(std::move(component));
+        }
+
+        // Components emplaced directly into the registry were not recorded - PositionC is not recorded either
+        size_t storageCount = 0;
+        for (const auto& [id, storage] : registry.storage())
+        {
+            if (storage.contains(prototype))
+                ++storageCount;
+        }
+        const bool isRecorded = storageCount == archetype.components.size() + 1;
+
+        // Effects outside the components are not repeated for the batch
+        const bool hasEffects = !recorder.children.empty() || registry.all_of<CameraC>(prototype) ||
+            global::PATH_DATA.solidEntities.contains(prototype) || global::STEER_DATA.agents.contains(prototype) ||
+            data.entityUpdateCache.contains(prototype, data.engineTicks);
+
+        archetype.position = registry.get<const PositionC>(prototype);
+        archetype.isScripted = data.isEntityScripted(prototype);
+        archetype.isBatchable = recorder.isCopyable && isRecorded && !hasEffects;
+
+        RemoveEntityData(prototype);
+        registry.destroy(prototype);
+        EntityDestroy(recorder.children); // Undone - created again with each entity of the type
+        return archetype;
+    }
+
+    std::vector<Entity> EntityCreateBatch(const EntityType type, const std::span<const Point> positions,
+                                          const MapID map, const float rotation)
     {
         const auto& config = global::ENGINE_CONFIG;
+        auto& ecs = global::ECS_DATA;
         auto& data = global::ENGINE_DATA;
-        auto& dynamic = global::DY_COLL_DATA;
         auto& registry = internal::REGISTRY;
 
-        if (!registry.valid(entity))
-            return false;
-        const auto& pos = internal::POSITION_GROUP.get<const PositionC>(entity);
+        std::vector<Entity> entities;
+        const auto funcIt = ecs.typeMap.find(type);
+        if (funcIt == ecs.typeMap.end())
+        {
+            LOG_ERROR("No method create method registered for that entity type!");
+            return entities;
+        }
 
-        if (data.destroyCallback)
-            data.destroyCallback(entity);
+        entities.reserve(positions.size());
+        const auto createSingle = [&]
+        {
+            for (const auto pos : positions)
+                entities.push_back(EntityCreate(type, pos, map, rotation));
+        };
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]] // Captured on the main thread only
+        {
+            createSingle();
+            return entities;
+        }
 
-        if (!config.isClientMode && data.isEntityScripted(entity)) [[likely]]
-            internal::GetScriptInternal(entity)->onDestroy(entity);
+        auto it = ecs.archetypes.find(type);
+        if (it == ecs.archetypes.end())
+        {
+            // The prototype id is taken while capturing another type (batch in a create function) - captured later
+            if (registry.valid(ECSData::PROTOTYPE_ID)) [[unlikely]]
+            {
+                createSingle();
+                return entities;
+            }
+            it = ecs.archetypes.emplace(type, CaptureArchetype(type, funcIt->second)).first;
+        }
+        const auto& archetype = it->second;
+        if (!archetype.isBatchable) [[unlikely]]
+        {
+            createSingle();
+            return entities;
+        }
 
-        data.entityUpdateCache.erase(entity);
-        std::erase(data.drawVec, entity);
-        std::erase(data.entityUpdateVec, entity);
-        std::erase(data.collisionVec, entity);
-        data.entityNScriptedSet.erase(entity);
-        dynamic.mapEntityGrids[pos.map].removeWithHoles(entity);
-        global::PATH_DATA.solidEntities.erase(entity);
-        if (entity == CameraGetEntity())
-            data.cameraEntity = entt::null;
+        if (NetworkIsClientMode())
+            LOG_WARNING("Created non-networked entity on the client");
+
+        auto& positionStorage = registry.storage<PositionC>();
+        positionStorage.reserve(positionStorage.size() + positions.size());
+        auto position = archetype.position;
+        position.map = map;
+        position.rotation = rotation;
+        for (const auto pos : positions)
+        {
+            const auto entity = registry.create(Entity{ecs.entityID++});
+            position.pos = pos;
+            registry.emplace<PositionC>(entity, position);
+            data.regionIndex.insert(entity, pos, map);
+            ecs.typeIndex.insert(entity, type);
+            if (!archetype.isScripted)
+                data.entityNScriptedSet.insert(entity);
+            entities.push_back(entity);
+        }
+        if (internal::ARCHETYPE_RECORDER != nullptr) [[unlikely]] // Batch created in a create function
+        {
+            auto& children = internal::ARCHETYPE_RECORDER->children;
+            children.insert(children.end(), entities.begin(), entities.end());
+        }
+
+        const auto* first = entities.data();
+        for (const auto& component : archetype.components)
+        {
+            component->apply(first, first + entities.size()); // Copies the component to all at once
+        }
+
+        if (data.createCallback)
+        {
+            for (const auto entity : entities)
+                data.createCallback(entity);
+        }
+
+        if (!config.isClientMode && !entities.empty()) [[likely]]
+        {
+            auto* script = internal::GetScriptInternal(entities.front()); // All have the same type
+            for (const auto entity : entities)
+            {
+                if (data.isEntityScripted(entity)) [[likely]]
+                    script->onCreate(entity);
+            }
+        }
+        return entities;
+    }
+
+    void EntitySetDestroyCallback(const EntityCallback& callback) { global::ENGINE_DATA.destroyCallback = callback; }
+
+    void EntitySetPosition(const Entity entity, const Point pos, const MapID map)
+    {
+        auto& posC = ComponentGet<PositionC>(entity);
+        posC.pos = pos;
+        posC.map = map;
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]] // The index is shared
+        {
+            internal::COMMAND_BUFFER->add([entity] { global::ENGINE_DATA.regionIndex.touched.push_back(entity); });
+            return;
+        }
+        global::ENGINE_DATA.regionIndex.touched.push_back(entity);
+    }
+
+    bool EntityDestroy(const Entity entity)
+    {
+        auto& registry = internal::REGISTRY;
+
+        if (!registry.valid(entity))
+            return false;
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]]
+        {
+            internal::COMMAND_BUFFER->add([entity] { EntityDestroy(entity); });
+            return true;
+        }
+
+        NotifyDestroy(entity);
+        RemoveEntityData(entity);
         registry.destroy(entity);
         return true;
     }
 
+    void EntityDestroy(const std::span<const Entity> entities)
+    {
+        auto& registry = internal::REGISTRY;
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]]
+        {
+            internal::COMMAND_BUFFER->add([copy = std::vector(entities.begin(), entities.end())]
+                                          { EntityDestroy(copy); });
+            return;
+        }
+
+        // All are notified first - so they can still access each other
+        for (const auto entity : entities)
+        {
+            if (registry.valid(entity))
+                NotifyDestroy(entity);
+        }
+        for (const auto entity : entities)
+        {
+            if (!registry.valid(entity)) // Destroyed in a callback
+                continue;
+            RemoveEntityData(entity);
+            registry.destroy(entity);
+        }
+    }
+
     void EntityDestroy(const std::initializer_list<EntityType>& ids)
     {
         const auto& config = global::ENGINE_CONFIG;
@@ -186,39 +416,50 @@ namespace magique
             data.collisionVec.clear();
             data.entityNScriptedSet.clear();
             dyCollData.mapEntityGrids.clear();
+            data.regionIndex.clear();
+            global::ECS_DATA.typeIndex.clear();
             internal::REGISTRY.clear();
             global::PATH_DATA.solidEntities.clear();
+            global::PATH_DATA.visibilityCache.clear();
+            global::STEER_DATA.agents.clear();
             data.cameraEntity = entt::null;
             return;
         }
 
-        for (const auto e : internal::REGISTRY.view<Entity>())
+        std::vector<Entity> entities; // Copied - destroying modifies the type index
+        for (auto it = ids.begin(); it != ids.end(); ++it)
         {
-            const auto& pos = group.get<PositionC>(e);
-            for (const auto id : ids)
-            {
-                if (pos.type == id)
-                {
-                    EntityDestroy(e);
-                    break;
-                }
-            }
+            if (std::find(ids.begin(), it, *it) != it) // Type is listed twice
+                continue;
+            const auto typeEntities = EntityGetAllOf(*it);
+            entities.insert(entities.end(), typeEntities.begin(), typeEntities.end());
         }
+        EntityDestroy(entities);
         // Don't need to patch as its cleared each tick
     }
 
     void EntityDestroy(const std::function<bool(Entity)>& func)
     {
+        std::vector<Entity> entities;
         for (const auto e : internal::REGISTRY.view<Entity>())
         {
             if (func(e))
             {
-                EntityDestroy(e);
+                entities.push_back(e);
             }
         }
+        EntityDestroy(entities);
     }
 
-    void EntityDestroyDeferred(Entity entity) { global::ENGINE_DATA.deferredDestroyVec.push_back(entity); }
+    void EntityDestroyDeferred(Entity entity)
+    {
+        if (internal::COMMAND_BUFFER != nullptr) [[unlikely]]
+        {
+            internal::COMMAND_BUFFER->add([entity] { EntityDestroyDeferred(entity); });
+            return;
+        }
+        global::ENGINE_DATA.deferredDestroyVec.push_back(entity);
+    }
 
     void EntityDestroyDeferred(const FilterFunc& func)
     {
@@ -233,21 +474,21 @@ namespace magique
 
     CollisionC& ComponentGiveCollisionRect(Entity entity, Rect rect, Point anchor)
     {
-        auto& col = internal::REGISTRY.emplace<CollisionC>(entity);
+        auto& col = ComponentGive<CollisionC>(entity);
         col.setRectShape(rect, anchor);
         return col;
     }
 
     CollisionC& ComponentGiveCollisionCircle(const Entity e, const float radius)
     {
-        auto& col = internal::REGISTRY.emplace<CollisionC>(e);
+        auto& col = ComponentGive<CollisionC>(e);
         col.setCircleShape(radius);
         return col;
     }
 
     CollisionC& ComponentGiveCollisionTri(const Entity e, const Point p2, const Point p3, Point anchor)
     {
-        return internal::REGISTRY.emplace<CollisionC>(e, p2.x, p2.y, p3.x, p3.y, Point{}, anchor, Shape::TRIANGLE);
+        return ComponentGive<CollisionC>(e, p2.x, p2.y, p3.x, p3.y, Point{}, anchor, Shape::TRIANGLE);
     }
 
     void ComponentGiveCamera(const Entity entity)
@@ -256,7 +497,12 @@ namespace magique
         global::ENGINE_DATA.cameraMap = ComponentGet<const PositionC>(entity).map;
     }
 
-    void ComponentGiveActor(const Entity e) { internal::REGISTRY.emplace<ActorC>(e); }
+    void ComponentGiveActor(const Entity e)
+    {
+        if (internal::ARCHETYPE_RECORDER != nullptr) [[unlikely]]
+            internal::ARCHETYPE_RECORDER->record<ActorC>(e);
+        internal::REGISTRY.emplace<ActorC>(e);
+    }
 
     //----------------- CORE -----------------//
 
@@ -355,8 +601,8 @@ namespace magique
         auto& data = global::ENGINE_DATA;
         auto& dynamic = global::DY_COLL_DATA;
         const auto& pos = POSITION_GROUP.get<const PositionC>(entity);
-        std::erase(data.collisionVec, entity);
-        dynamic.mapEntityGrids[pos.map].removeWithHoles(entity);
+        data.collisionSlots.remove(data.collisionVec, entity);
+        dynamic.removeEntity(entity, pos.map);
         global::PATH_DATA.solidEntities.erase(entity);
     }
 } // namespace magique
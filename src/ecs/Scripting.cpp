@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: zlib-acknowledgement
 #include <magique/ecs/Scripting.h>
+#include <magique/core/Engine.h>
 
 #include "internal/globals/ScriptData.h"
 #include "internal/globals/EngineData.h"
@@ -26,19 +27,24 @@ namespace magique
         }
     }
 
+    void ScriptingSetParallel(const EntityType type, const bool value)
+    {
+        auto& scData = global::SCRIPT_DATA;
+        if (value)
+        {
+            scData.parallelTypes.insert(type);
+        }
+        else
+        {
+            scData.parallelTypes.erase(type);
+        }
+    }
+
     namespace internal
     {
         EntityScript* GetScriptInternal(const Entity entity)
         {
-            const auto& scriptData = global::SCRIPT_DATA;
-            const auto type = ComponentGet<PositionC>(entity).type;
-            const auto it = scriptData.scripts.find(type);
-            MAGIQUE_ASSERT(it != scriptData.scripts.end(), "No script registered for this type! ");
-            if (it == scriptData.scripts.end())
-            {
-                return scriptData.defaultScript;
-            }
-            return it->second;
+            return global::SCRIPT_DATA.getScript(ComponentGet<PositionC>(entity).type);
         }
     } // namespace internal
 
@@ -57,6 +63,22 @@ namespace magique
 
     bool ScriptingGetIsScripted(const Entity entity) { return global::ENGINE_DATA.entityNScriptedSet.contains(entity); }
 
+    void EntityScript::onUpdateBatch(const std::span<const Entity> entities)
+    {
+        for (const auto entity : entities)
+        {
+            onUpdate(entity, EngineIsCached(entity));
+        }
+    }
+
+    void EntityScript::onUpdateEndBatch(const std::span<const Entity> entities)
+    {
+        for (const auto entity : entities)
+        {
+            onUpdateEnd(entity, EngineIsCached(entity));
+        }
+    }
+
     void EntityScript::AccumulateCollision(CollisionInfo& collision) { SetIsAccumulated(collision); }
 
 
@@ -4,6 +4,7 @@
 #include <magique/gamedev/PathFinding.h>
 #include <magique/ecs/ECS.h>
 #include <magique/core/Camera.h>
+#include <magique/util/JobSystem.h>
 
 #include "internal/globals/PathFindingData.h"
 
@@ -23,18 +24,442 @@ namespace magique
     bool PathFindPro(std::vector<Point>& pathVec, Point start, Point target, MapID map, int max, GridMode mode,
                      const Rect& bounds, PathFindHeuristicFunc hfunc)
     {
-        return global::PATH_DATA.findPath(pathVec, start, target, map, max, mode, hfunc);
+        const auto clearance = PathFindingData::GetRequiredClearance(bounds);
+        if (hfunc == nullptr) // Custom heuristics produce different paths
+            return global::PATH_DATA.findPathCached(pathVec, start, target, map, max, mode, clearance);
+        return global::PATH_DATA.findPath(pathVec, start, target, map, max, mode, clearance, hfunc);
     }
 
     bool PathFindNext(Point& next, const Point start, const Point end, const MapID map, const int maxLen, GridMode mode)
     {
         auto& path = global::PATH_DATA;
-        auto res = PathFindPro(path.pathCache, start, end, map, maxLen, mode);
+        // Not cached - only the next point is used and random targets (PathFindRandomTarget()) would evict real paths
+        auto res = path.findPath(path.pathCache, start, end, map, maxLen, mode);
         if (!path.pathCache.empty())
             next = path.pathCache[path.pathCache.size() - 1];
         return res;
     }
 
+    //----------------- AGENT -----------------//
+
+    // D* Lite - searches from the goal towards the agent so g-values stay valid when the agent moves
+    // Keys are not recomputed when the agent moves - the key offset keeps them lower bounds instead
+
+    static constexpr float AGENT_INF = 1e30F; // Finite so it works with fast-math
+
+    // Consistent with the move costs - required to reuse the search state
+    static float AgentDistance(const GridMode mode, const uint32_t from, const uint32_t to)
+    {
+        int x1, y1, x2, y2;
+        GetVisitedCellPos(from, x1, y1);
+        GetVisitedCellPos(to, x2, y2);
+        const auto dx = static_cast<float>(std::abs(x1 - x2));
+        const auto dy = static_cast<float>(std::abs(y1 - y2));
+        if (mode == GridMode::CROSS)
+            return dx + dy;
+        return dx + dy + ((MOVE_COST[1](Point{1, 1}) - 2.0F) * std::min(dx, dy));
+    }
+
+    static PathAgent::Key AgentKey(const PathAgent& agent, const uint32_t cell, const PathAgent::Node& node)
+    {
+        const float secondary = std::min(node.g, node.rhs);
+        return {secondary + AgentDistance(agent.mode, cell, agent.start) + agent.keyOffset, secondary, cell};
+    }
+
+    static uint32_t AgentNeighbour(const uint32_t cell, const Point& dir)
+    {
+        int x, y;
+        GetVisitedCellPos(cell, x, y);
+        return GetVisitedCellID(x + static_cast<int>(dir.x), y + static_cast<int>(dir.y));
+    }
+
+    static uint32_t AgentRegion(const int cellX, const int cellY)
+    {
+        return GetVisitedCellID(PathRegionVersions::GetRegion(cellX), PathRegionVersions::GetRegion(cellY));
+    }
+
+    // Cells within this range of a changed cell can change their clearance
+    static int AgentRegionPadding(const PathAgent& agent)
+    {
+        return agent.clearance > 1 ? ClearanceGrid::MAX_CLEARANCE - 1 : 0;
+    }
+
+    static bool AgentIsSolid(const PathAgent& agent, const uint32_t cell)
+    {
+        constexpr int cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
+        const auto& path = global::PATH_DATA;
+        int x, y;
+        GetVisitedCellPos(cell, x, y);
+        const auto worldX = static_cast<float>(x * cellSize);
+        const auto worldY = static_cast<float>(y * cellSize);
+        return PathFindingData::IsCellSolid(worldX, worldY, path.mapsStaticGrids[agent.map],
+                                            path.mapsDynamicGrids[agent.map]);
+    }
+
+    // Same checks as PathFindEx() - the cell of the agent is exempt when updating it (see AgentUpdateVertex())
+    static bool AgentIsBlocked(const PathAgent& agent, const uint32_t cell)
+    {
+        if (AgentIsSolid(agent, cell))
+            return true;
+        if (agent.clearance <= 1)
+            return false;
+        int x, y;
+        GetVisitedCellPos(cell, x, y);
+        return global::PATH_DATA.getClearance(x, y, agent.map) < agent.clearance;
+    }
+
+    // Remembers the versions of all regions whose changes can affect the cell
+    static void AgentTrackRegions(PathAgent& agent, const uint32_t cell)
+    {
+        const auto& versions = global::PATH_DATA.mapsRegionVersions[agent.map];
+        const int padding = AgentRegionPadding(agent);
+        int x, y;
+        GetVisitedCellPos(cell, x, y);
+        const auto addRegion = [&](const int cellX, const int cellY)
+        {
+            const auto region = AgentRegion(cellX, cellY);
+            if (!agent.regions.contains(region))
+                agent.regions.emplace(region, versions.getVersion(region));
+        };
+        addRegion(x - padding, y - padding);
+        addRegion(x + padding, y - padding);
+        addRegion(x - padding, y + padding);
+        addRegion(x + padding, y + padding);
+    }
+
+    // Returns nullptr if the node budget is exhausted
+    static PathAgent::Node* AgentGetNode(PathAgent& agent, const uint32_t cell)
+    {
+        const auto it = agent.nodes.find(cell);
+        if (it != agent.nodes.end())
+            return &it->second;
+        if (static_cast<int>(agent.nodes.size()) >= agent.maxNodes) [[unlikely]]
+        {
+            agent.isFull = true;
+            return nullptr;
+        }
+        AgentTrackRegions(agent, cell);
+        const PathAgent::Node node{AGENT_INF, AGENT_INF, AgentIsBlocked(agent, cell)};
+        return &agent.nodes.emplace(cell, node).first->second;
+    }
+
+    static void AgentUpdateVertex(PathAgent& agent, const uint32_t cell)
+    {
+        auto* node = AgentGetNode(agent, cell);
+        if (node == nullptr)
+            return;
+        if (cell == agent.goal)
+        {
+            node->rhs = node->blocked ? AGENT_INF : 0.0F;
+        }
+        else
+        {
+            float best = AGENT_INF;
+            if (!node->blocked || cell == agent.start) // The agent already stands on its cell
+            {
+                const auto moveCost = MOVE_COST[static_cast<int>(agent.mode)];
+                for (const auto& dir : MOVEMENTS[static_cast<int>(agent.mode)])
+                {
+                    const auto it = agent.nodes.find(AgentNeighbour(cell, dir));
+                    if (it == agent.nodes.end() || it->second.blocked || it->second.g >= AGENT_INF)
+                        continue;
+                    best = std::min(best, it->second.g + moveCost(dir));
+                }
+            }
+            node->rhs = best;
+        }
+        if (node->g != node->rhs)
+            agent.open.push(AgentKey(agent, cell, *node)); // Outdated entries are skipped when popped
+    }
+
+    static void AgentUpdateNeighbours(PathAgent& agent, const uint32_t cell)
+    {
+        for (const auto& dir : MOVEMENTS[static_cast<int>(agent.mode)])
+            AgentUpdateVertex(agent, AgentNeighbour(cell, dir));
+    }
+
+    static void AgentRestart(PathAgent& agent, const uint32_t start, const uint32_t goal, const uint32_t staticVersion)
+    {
+        agent.reset();
+        agent.start = start;
+        agent.goal = goal;
+        agent.staticVersion = staticVersion;
+        agent.isValid = AgentGetNode(agent, goal) != nullptr; // Budget can be 0
+        if (agent.isValid)
+            AgentUpdateVertex(agent, goal);
+    }
+
+    // The key offset grows by the distance moved - keys of queued nodes stay lower bounds
+    static void AgentMoveStart(PathAgent& agent, const uint32_t start)
+    {
+        if (start == agent.start)
+            return;
+        const auto previous = agent.start;
+        agent.keyOffset += AgentDistance(agent.mode, previous, start);
+        agent.start = start;
+        if (agent.nodes.contains(previous)) // No longer exempt from being blocked
+            AgentUpdateVertex(agent, previous);
+        if (agent.nodes.contains(start))
+            AgentUpdateVertex(agent, start);
+    }
+
+    // Only the regions that changed since the last check are scanned for cells that changed their blocked state
+    static void AgentApplyCellChanges(PathAgent& agent)
+    {
+        constexpr int regionSize = PathRegionVersions::REGION_SIZE;
+        const auto& versions = global::PATH_DATA.mapsRegionVersions[agent.map];
+        const int padding = AgentRegionPadding(agent);
+        agent.changedCells.clear();
+        for (auto& [region, version] : agent.regions)
+        {
+            const auto current = versions.getVersion(region);
+            if (current == version) [[likely]]
+                continue;
+            version = current;
+            int regionX, regionY;
+            GetVisitedCellPos(region, regionX, regionY);
+            for (int y = regionY * regionSize - padding; y < (regionY + 1) * regionSize + padding; ++y)
+            {
+                for (int x = regionX * regionSize - padding; x < (regionX + 1) * regionSize + padding; ++x)
+                {
+                    const auto cell = GetVisitedCellID(x, y);
+                    const auto it = agent.nodes.find(cell);
+                    if (it == agent.nodes.end())
+                        continue;
+                    const bool blocked = AgentIsBlocked(agent, cell);
+                    if (blocked != it->second.blocked)
+                    {
+                        it->second.blocked = blocked;
+                        agent.changedCells.push_back(cell);
+                    }
+                }
+            }
+        }
+        for (const auto cell : agent.changedCells)
+        {
+            AgentUpdateVertex(agent, cell);
+            for (const auto& dir : MOVEMENTS[static_cast<int>(agent.mode)])
+            {
+                const auto neighbour = AgentNeighbour(cell, dir);
+                if (agent.nodes.contains(neighbour))
+                    AgentUpdateVertex(agent, neighbour);
+            }
+        }
+    }
+
+    static void AgentComputePath(PathAgent& agent)
+    {
+        int budget = agent.maxNodes * 4; // Guards against endless repairs
+        while (!agent.open.empty() && budget-- > 0)
+        {
+            const auto top = agent.open.top();
+            const auto& node = agent.nodes[top.cell];
+            if (node.g == node.rhs) // Outdated entry
+            {
+                agent.open.pop();
+                continue;
+            }
+            const auto current = AgentKey(agent, top.cell, node);
+            if (current > top || top > current) // Queued with an old key - queued again with the current one
+            {
+                agent.open.pop();
+                agent.open.push(current);
+                continue;
+            }
+
+            const auto startIt = agent.nodes.find(agent.start);
+            if (startIt != agent.nodes.end())
+            {
+                const auto& startNode = startIt->second;
+                if (startNode.g == startNode.rhs && !(AgentKey(agent, agent.start, startNode) > top))
+                    break;
+            }
+
+            agent.open.pop();
+            if (node.g > node.rhs)
+            {
+                agent.nodes[top.cell].g = node.rhs;
+                AgentUpdateNeighbours(agent, top.cell);
+            }
+            else
+            {
+                agent.nodes[top.cell].g = AGENT_INF;
+                AgentUpdateVertex(agent, top.cell);
+                AgentUpdateNeighbours(agent, top.cell);
+            }
+        }
+    }
+
+    // Walks down the costs from the agent to the goal - returns true if the goal is reached
+    static bool AgentExtractPath(PathAgent& agent)
+    {
+        constexpr float cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
+        agent.path.clear();
+        const auto startIt = agent.nodes.find(agent.start);
+        if (startIt == agent.nodes.end() || startIt->second.g >= AGENT_INF)
+            return false;
+
+        const auto moveCost = MOVE_COST[static_cast<int>(agent.mode)];
+        auto current = agent.start;
+        for (int steps = 0; current != agent.goal && steps < agent.maxNodes; ++steps)
+        {
+            auto next = current;
+            float best = AGENT_INF;
+            for (const auto& dir : MOVEMENTS[static_cast<int>(agent.mode)])
+            {
+                const auto neighbour = AgentNeighbour(current, dir);
+                const auto it = agent.nodes.find(neighbour);
+                if (it == agent.nodes.end() || it->second.blocked)
+                    continue;
+                const auto cost = it->second.g + moveCost(dir);
+                if (cost < best)
+                {
+                    best = cost;
+                    next = neighbour;
+                }
+            }
+            if (next == current) [[unlikely]]
+                break;
+            current = next;
+            int x, y;
+            GetVisitedCellPos(current, x, y);
+            agent.path.push_back({(static_cast<float>(x) * cellSize) + (cellSize / 2.0F),
+                                  (static_cast<float>(y) * cellSize) + (cellSize / 2.0F)});
+        }
+        std::ranges::reverse(agent.path); // Last element is the next point
+        return current == agent.goal;
+    }
+
+    static void AgentSmoothPath(PathAgent& agent, const Point start)
+    {
+        if (agent.mode == GridMode::ANY)
+            global::PATH_DATA.smoothPath(agent.path, start, agent.map, agent.clearance);
+    }
+
+    PathAgent::PathAgent(const GridMode mode, const Rect& hitbox, const int maxNodes) :
+        maxNodes(maxNodes), mode(mode), clearance(PathFindingData::GetRequiredClearance(hitbox))
+    {
+        nodes.reserve(std::max(maxNodes, 0)); // Node references stay valid as the budget is never exceeded
+    }
+
+    bool PathAgent::update(const Point start, const Point target, const MapID newMap)
+    {
+        constexpr int cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
+        auto& data = global::PATH_DATA;
+        const auto startCell = GetVisitedCellID(floordiv<cellSize>(start.x), floordiv<cellSize>(start.y));
+        const auto targetCell = GetVisitedCellID(floordiv<cellSize>(target.x), floordiv<cellSize>(target.y));
+
+        if (map != newMap)
+        {
+            map = newMap;
+            isValid = false;
+        }
+
+        if (AgentIsSolid(*this, startCell)) [[unlikely]]
+        {
+            path.clear();
+            return false;
+        }
+
+        auto& versions = data.mapsRegionVersions[map];
+        versions.sync(data.mapsDynamicGrids[map], data.dynamicEpoch);
+
+        if (isValid && !isFull && goal == targetCell && staticVersion == versions.staticVersion)
+        {
+            AgentMoveStart(*this, startCell);
+            AgentApplyCellChanges(*this);
+        }
+        else
+        {
+            AgentRestart(*this, startCell, targetCell, versions.staticVersion);
+        }
+
+        AgentComputePath(*this);
+        if (AgentExtractPath(*this)) [[likely]]
+        {
+            AgentSmoothPath(*this, start);
+            return true;
+        }
+
+        // Unreachable or over budget - gets as close as possible like PathFindEx()
+        const auto maxLen = static_cast<uint16_t>(std::clamp(maxNodes, 0, MAGIQUE_MAX_PATH_SEARCH_CAPACITY));
+        return data.findPath(path, start, target, map, maxLen, mode, clearance);
+    }
+
+    const std::vector<Point>& PathAgent::getPath() const { return path; }
+
+    void PathAgent::reset()
+    {
+        nodes.clear();
+        regions.clear();
+        open.clear();
+        path.clear();
+        keyOffset = 0.0F;
+        isValid = false;
+        isFull = false;
+    }
+
+    //----------------- ASYNC -----------------//
+
+    PathRequestID PathFindAsync(const Point start, const Point target, const MapID map, const int max,
+                                const GridMode mode, const Rect& hitbox)
+    {
+        PathRequest request;
+        request.start = start;
+        request.target = target;
+        request.maxLen = static_cast<uint16_t>(max);
+        request.mode = mode;
+        request.clearance = PathFindingData::GetRequiredClearance(hitbox);
+        request.map = map;
+        return global::PATH_DATA.addRequest(std::move(request));
+    }
+
+    PathRequestID PathFindRandomTargetAsync(const Point start, const Rect& area, const MapID map, const int iterations)
+    {
+        if (iterations <= 0) [[unlikely]]
+            return PathRequestID::null;
+        PathRequest request;
+        request.area = area;
+        request.start = start;
+        request.target = Point{-1};
+        request.samples = static_cast<uint16_t>(std::min(iterations, static_cast<int>(UINT16_MAX)));
+        request.map = map;
+        return global::PATH_DATA.addRequest(std::move(request));
+    }
+
+    PathStatus PathRequestPoll(const PathRequestID id, std::vector<Point>& path, Point* target)
+    {
+        auto& data = global::PATH_DATA;
+        auto* request = data.getRequest(id);
+        if (request == nullptr)
+            return PathStatus::INVALID;
+
+        const auto status = request->status;
+        if (status == PathStatus::PENDING)
+            return status;
+
+        std::swap(path, request->path); // Hands over the path and recycles the callers vector
+        if (target != nullptr)
+            *target = request->target;
+        data.releaseRequest(id);
+        return status;
+    }
+
+    void PathRequestCancel(const PathRequestID id)
+    {
+        auto& data = global::PATH_DATA;
+        if (data.getRequest(id) != nullptr)
+            data.releaseRequest(id);
+    }
+
+    void PathSetCacheSize(const int entries) { global::PATH_DATA.cache.setCapacity(entries); }
+
+    void PathSetRequestBudget(const int nodesPerTick)
+    {
+        MAGIQUE_ASSERT(nodesPerTick > 0, "Budget must be positive");
+        global::PATH_DATA.requestBudget = nodesPerTick;
+    }
+
     bool PathRayCast(const Point start, const Point end, const MapID map)
     {
         auto& path = global::PATH_DATA;
@@ -97,6 +522,211 @@ namespace magique
         return PathFindingData::IsCellSolid(pos.x, pos.y, staticGrid, dynamicGrid);
     }
 
+    int PathGetClearance(const Point& pos, const MapID map)
+    {
+        constexpr int cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
+        if (PathIsSolid(pos, map))
+            return 0;
+        return global::PATH_DATA.getClearance(floordiv<cellSize>(pos.x), floordiv<cellSize>(pos.y), map);
+    }
+
+    //----------------- VISIBILITY -----------------//
+
+    // Recursive shadowcasting of a single octant - slopes are given as dx/dy of the cell edges
+    static void VisibilityCastLight(PathVisibility& vis, const PathFindingGrid& staticGrid,
+                                    const PathFindingGrid& dynamicGrid, const int row, float startSlope,
+                                    const float endSlope, const int xx, const int xy, const int yx, const int yy)
+    {
+        constexpr int cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
+        if (startSlope < endSlope)
+            return;
+
+        const int radius = vis.radius;
+        const int side = (2 * radius) + 1;
+        const int radiusSqr = radius * radius;
+        float nextStartSlope = startSlope;
+        for (int j = row; j <= radius; ++j)
+        {
+            bool blocked = false;
+            const int dy = -j;
+            for (int dx = -j; dx <= 0; ++dx)
+            {
+                const float leftSlope = (static_cast<float>(dx) - 0.5F) / (static_cast<float>(dy) + 0.5F);
+                const float rightSlope = (static_cast<float>(dx) + 0.5F) / (static_cast<float>(dy) - 0.5F);
+                if (startSlope < rightSlope)
+                    continue;
+                if (endSlope > leftSlope)
+                    break;
+
+                const int localX = (dx * xx) + (dy * xy);
+                const int localY = (dx * yx) + (dy * yy);
+                const int x = vis.originX + localX;
+                const int y = vis.originY + localY;
+                if ((dx * dx) + (dy * dy) <= radiusSqr)
+                {
+                    const int bit = ((localY + radius) * side) + localX + radius;
+                    vis.cells[bit / 64] |= uint64_t{1} << (bit % 64);
+                }
+
+                const auto worldX = static_cast<float>(x * cellSize);
+                const auto worldY = static_cast<float>(y * cellSize);
+                const bool isSolid = PathFindingData::IsCellSolid(worldX, worldY, staticGrid, dynamicGrid);
+                if (blocked)
+                {
+                    if (isSolid)
+                    {
+                        nextStartSlope = rightSlope;
+                        continue;
+                    }
+                    blocked = false;
+                    startSlope = nextStartSlope;
+                }
+                else if (isSolid && j < radius)
+                {
+                    blocked = true;
+                    VisibilityCastLight(vis, staticGrid, dynamicGrid, j + 1, startSlope, leftSlope, xx, xy, yx, yy);
+                    nextStartSlope = rightSlope;
+                }
+            }
+            if (blocked)
+                break;
+        }
+    }
+
+    // Only accesses existing grids - called from multiple threads
+    static void VisibilityCompute(PathVisibility& vis)
+    {
+        constexpr int octants[8][4] = {{1, 0, 0, 1},  {0, 1, 1, 0},  {0, -1, 1, 0}, {-1, 0, 0, 1},
+                                       {-1, 0, 0, -1}, {0, -1, -1, 0}, {0, 1, -1, 0}, {1, 0, 0, -1}};
+        const auto& path = global::PATH_DATA;
+        const auto& staticGrid = path.mapsStaticGrids[vis.map];
+        const auto& dynamicGrid = path.mapsDynamicGrids[vis.map];
+
+        const int side = (2 * vis.radius) + 1;
+        vis.cells.assign(((side * side) + 63) / 64, 0);
+        const int originBit = (vis.radius * side) + vis.radius;
+        vis.cells[originBit / 64] |= uint64_t{1} << (originBit % 64);
+        for (const auto& [xx, xy, yx, yy] : octants)
+        {
+            VisibilityCastLight(vis, staticGrid, dynamicGrid, 1, 1.0F, 0.0F, xx, xy, yx, yy);
+        }
+    }
+
+    static void VisibilityComputeRange(const int start, const int end)
+    {
+        const auto& tasks = global::PATH_DATA.visibilityTasks;
+        for (int i = start; i < end; ++i)
+        {
+            VisibilityCompute(*tasks[i]);
+        }
+    }
+
+    // Prepares the cache entry - returns false if it's still valid
+    static bool VisibilityPrepare(PathVisibility& vis, const Point origin, const MapID map, const int radius)
+    {
+        constexpr int cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
+        auto& path = global::PATH_DATA;
+        const int originX = floordiv<cellSize>(origin.x);
+        const int originY = floordiv<cellSize>(origin.y);
+        const auto staticVersion = path.mapsRegionVersions[map].staticVersion;
+        if (vis.epoch == path.dynamicEpoch && vis.radius == radius && vis.map == map && vis.originX == originX &&
+            vis.originY == originY && vis.staticVersion == staticVersion)
+        {
+            return false;
+        }
+        vis.originX = originX;
+        vis.originY = originY;
+        vis.radius = radius;
+        vis.epoch = path.dynamicEpoch;
+        vis.staticVersion = staticVersion;
+        vis.map = map;
+        // Make sure the grids exist - workers only read them
+        path.mapsStaticGrids[map];
+        path.mapsDynamicGrids[map];
+        return true;
+    }
+
+    bool PathVisibility::isVisible(const Point& pos) const
+    {
+        constexpr int cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
+        const int localX = floordiv<cellSize>(pos.x) - originX + radius;
+        const int localY = floordiv<cellSize>(pos.y) - originY + radius;
+        const int side = (2 * radius) + 1;
+        if (cells.empty() || localX < 0 || localY < 0 || localX >= side || localY >= side)
+            return false;
+        const int bit = (localY * side) + localX;
+        return (cells[bit / 64] & (uint64_t{1} << (bit % 64))) != 0;
+    }
+
+    Point PathVisibility::getOrigin() const
+    {
+        constexpr float cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
+        return {(static_cast<float>(originX) * cellSize) + (cellSize / 2.0F),
+                (static_cast<float>(originY) * cellSize) + (cellSize / 2.0F)};
+    }
+
+    int PathVisibility::getRadius() const { return radius; }
+
+    void PathComputeVisibility(PathVisibility& visibility, const Point origin, const MapID map, const int radius)
+    {
+        MAGIQUE_ASSERT(radius >= 0, "Radius must be positive");
+        visibility.epoch = UINT32_MAX; // Never reused from the cache
+        VisibilityPrepare(visibility, origin, map, radius);
+        VisibilityCompute(visibility);
+    }
+
+    const PathVisibility& PathGetVisibility(const Entity observer, const int radius)
+    {
+        MAGIQUE_ASSERT(radius >= 0, "Radius must be positive");
+        const auto* pos = ComponentTryGet<PositionC>(observer);
+        if (pos == nullptr) [[unlikely]]
+        {
+            static const PathVisibility EMPTY{}; // Not cached - would leak an entry for each such entity
+            return EMPTY;
+        }
+        auto& vis = global::PATH_DATA.visibilityCache[observer];
+        if (VisibilityPrepare(vis, CollisionC::GetMiddle(observer), pos->map, radius))
+            VisibilityCompute(vis);
+        return vis;
+    }
+
+    void PathComputeVisibility(const std::span<const Entity> observers, const int radius)
+    {
+        MAGIQUE_ASSERT(radius >= 0, "Radius must be positive");
+        auto& path = global::PATH_DATA;
+        auto& tasks = path.visibilityTasks;
+
+        // Insert all first - inserting can move the entries
+        for (const auto e : observers)
+        {
+            if (ComponentTryGet<PositionC>(e) != nullptr) [[likely]]
+                path.visibilityCache[e];
+        }
+
+        tasks.clear();
+        for (const auto e : observers)
+        {
+            const auto* pos = ComponentTryGet<PositionC>(e);
+            if (pos == nullptr) [[unlikely]]
+                continue;
+            auto& vis = path.visibilityCache.find(e)->second;
+            if (VisibilityPrepare(vis, CollisionC::GetMiddle(e), pos->map, radius))
+                tasks.push_back(&vis);
+        }
+
+        const auto computeRange = [](int, const int start, const int end) { VisibilityComputeRange(start, end); };
+        JobParallelFor(static_cast<int>(tasks.size()), 4, computeRange);
+    }
+
+    bool PathCanSee(const Entity observer, const Entity target, const int radius)
+    {
+        const auto* observerPos = ComponentTryGet<PositionC>(observer);
+        const auto* targetPos = ComponentTryGet<PositionC>(target);
+        if (observerPos == nullptr || targetPos == nullptr || observerPos->map != targetPos->map) [[unlikely]]
+            return false;
+        return PathGetVisibility(observer, radius).isVisible(CollisionC::GetMiddle(target));
+    }
+
     Point PathFindRandomTarget(Point start, const Rect& area, MapID map, int iterations)
     {
         for (int i = 0; i < iterations; i++)
@@ -113,56 +743,44 @@ namespace magique
 
     Point PathGetNextOnPath(const Point& pos, const Point& target, const std::vector<Point>& path)
     {
+        constexpr float cellSize = MAGIQUE_PATHFINDING_CELL_SIZE;
         if (path.empty())
             return pos.dir(target);
 
-        // Stored in reverse
-        int lowestIdx = -1;
-        float lowestDist = std::numeric_limits<float>::max();
-        const auto targetDist = pos.euclidean(target);
-        if (targetDist < MAGIQUE_PATHFINDING_CELL_SIZE)
+        if (pos.euclidean(target) < cellSize)
         {
             return target;
         }
-        for (int i = (int)path.size() - 1; i >= 0; --i)
+
+        // Stored in reverse - follow the segment closest to the position
+        // Works for both cell paths and corner paths (GridMode::ANY)
+        const auto segmentDistanceSqr = [&](const Point& p, const Point& q)
         {
-            const auto& curr = path[i];
-            const auto dist = pos.euclidean(curr);
-            if (dist < lowestDist)
-            {
-                lowestIdx = i;
-                lowestDist = dist;
-            }
-            // We found the current cell
-            if (dist < MAGIQUE_PATHFINDING_CELL_SIZE)
+            const auto lineVec = q - p;
+            const auto lineLenSqr = lineVec.dot(lineVec);
+            const float t = lineLenSqr > 0.0F ? std::clamp(lineVec.dot(pos - p) / lineLenSqr, 0.0F, 1.0F) : 0.0F;
+            return pos.euclideanSqr(p + (lineVec * t));
+        };
+
+        const int last = static_cast<int>(path.size()) - 1;
+        int bestIdx = last;
+        float bestDist = pos.euclideanSqr(path[last]); // Before the first segment
+        for (int i = last - 1; i >= 0; --i)
+        {
+            const auto dist = segmentDistanceSqr(path[i + 1], path[i]);
+            if (dist < bestDist)
             {
-                // We are in the last cell
-                if (i == static_cast<int>(path.size()) - 1)
-                {
-                    return curr;
-                }
-                else
-                {
-                    // We are towards the next cell - dont wanna go back to the middle of current cell
-                    if (pos.euclidean(curr) < MAGIQUE_PATHFINDING_CELL_SIZE)
-                    {
-                        return path[i + 1];
-                    }
-                    else
-                    {
-                        return curr;
-                    }
-                }
+                bestIdx = i;
+                bestDist = dist;
             }
         }
-        if (lowestIdx != -1)
-        {
-            return path[lowestIdx];
-        }
-        else
+
+        // Reached the end of the segment - dont wanna go back to its middle
+        if (bestIdx > 0 && pos.euclidean(path[bestIdx]) < cellSize / 2.0F)
         {
-            return target;
+            return path[bestIdx - 1];
         }
+        return path[bestIdx];
     }
 
     void PathSetSolidType(const EntityType type, const bool value)
@@ -0,0 +1,340 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#include <magique/gamedev/Steering.h>
+#include <magique/ecs/ECS.h>
+#include <magique/ecs/Components.h>
+#include <magique/util/JobSystem.h>
+#include <magique/util/Logging.h>
+
+#include "internal/globals/SteeringData.h"
+#include "internal/globals/DynamicCollisionData.h"
+
+namespace magique
+{
+    static constexpr float STEER_EPSILON = 0.00001F;
+
+    static float Det(const Point& a, const Point& b) { return (a.x * b.y) - (a.y * b.x); }
+
+    static float GetBoundsRadius(const PositionC& pos, const CollisionC& col)
+    {
+        const auto bounds = pos.getBounds(col);
+        return std::max(bounds.width, bounds.height) / 2.0F;
+    }
+
+    //----------------- LINEAR PROGRAMS -----------------//
+    // Finds the velocity closest to the preferred one that satisfies all ORCA half-planes within the max speed
+    // Based on "Reciprocal n-body Collision Avoidance" (van den Berg et al.)
+
+    // Solves along a single line constrained by the lines before it
+    static bool LinearProgram1(const std::vector<OrcaLine>& lines, const int lineNo, const float radius,
+                               const Point& optVelocity, const bool directionOpt, Point& result)
+    {
+        const auto& line = lines[lineNo];
+        const float dotProduct = line.point.dot(line.direction);
+        const float discriminant = (dotProduct * dotProduct) + (radius * radius) - line.point.dot(line.point);
+        if (discriminant < 0.0F)
+            return false; // Max speed circle fully invalidates the line
+
+        const float sqrtDiscriminant = std::sqrt(discriminant);
+        float tLeft = -dotProduct - sqrtDiscriminant;
+        float tRight = -dotProduct + sqrtDiscriminant;
+        for (int i = 0; i < lineNo; ++i)
+        {
+            const float denominator = Det(line.direction, lines[i].direction);
+            const float numerator = Det(lines[i].direction, line.point - lines[i].point);
+            if (std::abs(denominator) <= STEER_EPSILON) // Parallel lines
+            {
+                if (numerator < 0.0F)
+                    return false;
+                continue;
+            }
+
+            const float t = numerator / denominator;
+            if (denominator >= 0.0F)
+                tRight = std::min(tRight, t);
+            else
+                tLeft = std::max(tLeft, t);
+            if (tLeft > tRight)
+                return false;
+        }
+
+        if (directionOpt)
+        {
+            result = line.point + (line.direction * (optVelocity.dot(line.direction) > 0.0F ? tRight : tLeft));
+            return true;
+        }
+        const float t = std::clamp(line.direction.dot(optVelocity - line.point), tLeft, tRight);
+        result = line.point + (line.direction * t);
+        return true;
+    }
+
+    // Returns the index of the line it failed on - lines.size() on success
+    static int LinearProgram2(const std::vector<OrcaLine>& lines, const float radius, const Point& optVelocity,
+                              const bool directionOpt, Point& result)
+    {
+        if (directionOpt)
+            result = optVelocity * radius; // Optimization direction is a unit vector
+        else if (optVelocity.dot(optVelocity) > radius * radius)
+            result = optVelocity.normalized() * radius;
+        else
+            result = optVelocity;
+
+        const int size = static_cast<int>(lines.size());
+        for (int i = 0; i < size; ++i)
+        {
+            if (Det(lines[i].direction, lines[i].point - result) > 0.0F) // Result violates the line
+            {
+                const auto previous = result;
+                if (!LinearProgram1(lines, i, radius, optVelocity, directionOpt, result))
+                {
+                    result = previous;
+                    return i;
+                }
+            }
+        }
+        return size;
+    }
+
+    // Infeasible - minimizes the maximum violation of the lines starting at beginLine
+    static void LinearProgram3(const std::vector<OrcaLine>& lines, const int beginLine, const float radius,
+                               Point& result, std::vector<OrcaLine>& projectedLines)
+    {
+        float distance = 0.0F;
+        const int size = static_cast<int>(lines.size());
+        for (int i = beginLine; i < size; ++i)
+        {
+            const auto& line = lines[i];
+            if (Det(line.direction, line.point - result) <= distance)
+                continue;
+
+            projectedLines.clear();
+            for (int j = 0; j < i; ++j)
+            {
+                OrcaLine projected;
+                const float determinant = Det(line.direction, lines[j].direction);
+                if (std::abs(determinant) <= STEER_EPSILON)
+                {
+                    if (line.direction.dot(lines[j].direction) > 0.0F)
+                        continue; // Same direction
+                    projected.point = (line.point + lines[j].point) * 0.5F;
+                }
+                else
+                {
+                    const float t = Det(lines[j].direction, line.point - lines[j].point) / determinant;
+                    projected.point = line.point + (line.direction * t);
+                }
+                projected.direction = (lines[j].direction - line.direction).normalized();
+                projectedLines.push_back(projected);
+            }
+
+            const auto previous = result;
+            const Point optDirection{-line.direction.y, line.direction.x};
+            if (LinearProgram2(projectedLines, radius, optDirection, true, result) <
+                static_cast<int>(projectedLines.size()))
+            {
+                result = previous; // Only fails due to floating point errors - keep the last result
+            }
+            distance = Det(line.direction, line.point - result);
+        }
+    }
+
+    //----------------- AGENTS -----------------//
+
+    // Half-plane of velocities that avoid the other within the time horizon
+    // responsibility is the share of the avoidance this agent takes - 0.5 for agents, 1 for non-moving obstacles
+    static OrcaLine GetOrcaLine(const SteerAgent& agent, const Point& otherPos, const Point& otherVelocity,
+                                const float otherRadius, const float responsibility)
+    {
+        const auto relativePosition = otherPos - agent.position;
+        const auto relativeVelocity = agent.velocity - otherVelocity;
+        const float distSqr = relativePosition.dot(relativePosition);
+        const float combinedRadius = agent.usedRadius + otherRadius;
+        const float combinedRadiusSqr = combinedRadius * combinedRadius;
+        const float invTimeHorizon = 1.0F / agent.timeHorizon;
+
+        OrcaLine line;
+        Point u;
+        if (distSqr > combinedRadiusSqr) // No collision
+        {
+            // Vector from the cutoff center to the relative velocity
+            const auto w = relativeVelocity - (relativePosition * invTimeHorizon);
+            const float wLengthSqr = w.dot(w);
+            const float dotProduct = w.dot(relativePosition);
+            if (dotProduct < 0.0F && dotProduct * dotProduct > combinedRadiusSqr * wLengthSqr)
+            {
+                // Project on the cutoff circle
+                const float wLength = std::sqrt(wLengthSqr);
+                const auto unitW = w / wLength;
+                line.direction = {unitW.y, -unitW.x};
+                u = unitW * ((combinedRadius * invTimeHorizon) - wLength);
+            }
+            else
+            {
+                // Project on the legs
+                const float leg = std::sqrt(distSqr - combinedRadiusSqr);
+                if (Det(relativePosition, w) > 0.0F) // Left leg
+                {
+                    line.direction = Point{(relativePosition.x * leg) - (relativePosition.y * combinedRadius),
+                                           (relativePosition.x * combinedRadius) + (relativePosition.y * leg)} /
+                        distSqr;
+                }
+                else // Right leg
+                {
+                    line.direction = -Point{(relativePosition.x * leg) + (relativePosition.y * combinedRadius),
+                                            (-relativePosition.x * combinedRadius) + (relativePosition.y * leg)} /
+                        distSqr;
+                }
+                u = (line.direction * relativeVelocity.dot(line.direction)) - relativeVelocity;
+            }
+        }
+        else // Already colliding - resolve within the next tick
+        {
+            const auto w = relativeVelocity - relativePosition;
+            const float wLength = std::max(w.magnitude(), STEER_EPSILON);
+            const auto unitW = w / wLength;
+            line.direction = {unitW.y, -unitW.x};
+            u = unitW * (combinedRadius - wLength);
+        }
+        line.point = agent.velocity + (u * responsibility);
+        return line;
+    }
+
+    static void ComputeAgent(const Entity entity, SteerAgent& agent, SteerScratch& scratch)
+    {
+        const auto& steerData = global::STEER_DATA;
+        const auto& grid = global::DY_COLL_DATA.mapEntityGrids[agent.map];
+
+        // Gather the closest neighbours within reach
+        const float range = agent.usedRadius + (agent.maxSpeed * agent.timeHorizon);
+        scratch.query.clear();
+        grid.query(scratch.query, Rect{agent.position - range, Point{range * 2.0F}});
+        std::ranges::sort(scratch.query);
+        const auto [first, last] = std::ranges::unique(scratch.query); // Entities can be in multiple cells
+        scratch.query.erase(first, last);
+
+        scratch.neighbours.clear();
+        for (const auto other : scratch.query)
+        {
+            if (other == entity)
+                continue;
+            const auto& pos = internal::POSITION_GROUP.get<const PositionC>(other);
+            if (pos.map != agent.map)
+                continue;
+            const auto& col = internal::POSITION_GROUP.get<const CollisionC>(other);
+            const float distSqr = pos.getMiddle(col).euclideanSqr(agent.position);
+            if (distSqr < range * range)
+                scratch.neighbours.emplace_back(distSqr, other);
+        }
+        if (static_cast<int>(scratch.neighbours.size()) > SteeringData::MAX_NEIGHBOURS)
+        {
+            const auto nth = scratch.neighbours.begin() + SteeringData::MAX_NEIGHBOURS;
+            std::ranges::nth_element(scratch.neighbours, nth);
+            scratch.neighbours.erase(nth, scratch.neighbours.end());
+        }
+
+        scratch.lines.clear();
+        for (const auto& [distSqr, other] : scratch.neighbours)
+        {
+            const auto it = steerData.agents.find(other);
+            if (it != steerData.agents.end() && it->second.isValid)
+            {
+                const auto& otherAgent = it->second;
+                scratch.lines.push_back(
+                    GetOrcaLine(agent, otherAgent.position, otherAgent.velocity, otherAgent.usedRadius, 0.5F));
+            }
+            else
+            {
+                const auto& pos = internal::POSITION_GROUP.get<const PositionC>(other);
+                const auto& col = internal::POSITION_GROUP.get<const CollisionC>(other);
+                scratch.lines.push_back(GetOrcaLine(agent, pos.getMiddle(col), {}, GetBoundsRadius(pos, col), 1.0F));
+            }
+        }
+
+        const int lineFail = LinearProgram2(scratch.lines, agent.maxSpeed, agent.preferred, false, agent.newVelocity);
+        if (lineFail < static_cast<int>(scratch.lines.size()))
+        {
+            LinearProgram3(scratch.lines, lineFail, agent.maxSpeed, agent.newVelocity, scratch.projectedLines);
+        }
+    }
+
+    static void ComputeAgentRange(const int thread, const int start, const int end)
+    {
+        auto& steerData = global::STEER_DATA;
+        auto& scratch = steerData.scratch[thread];
+        const auto begin = steerData.agents.begin(); // Values are stored densely
+        for (int i = start; i < end; ++i)
+        {
+            auto& [entity, agent] = begin[i];
+            if (agent.isValid) [[likely]]
+                ComputeAgent(entity, agent, scratch);
+        }
+    }
+
+    void SteerAddAgent(const Entity entity, const float maxSpeed, const float timeHorizon, const float radius)
+    {
+        MAGIQUE_ASSERT(maxSpeed >= 0.0F && timeHorizon > 0.0F && radius >= 0.0F, "Invalid steering parameters");
+        auto& agent = global::STEER_DATA.agents[entity];
+        agent.maxSpeed = maxSpeed;
+        agent.timeHorizon = timeHorizon;
+        agent.radius = radius;
+    }
+
+    void SteerRemoveAgent(const Entity entity) { global::STEER_DATA.agents.erase(entity); }
+
+    bool SteerIsAgent(const Entity entity) { return global::STEER_DATA.agents.contains(entity); }
+
+    //----------------- VELOCITY -----------------//
+
+    void SteerSetPreferred(const Entity entity, const Point velocity)
+    {
+        auto& agents = global::STEER_DATA.agents;
+        const auto it = agents.find(entity);
+        if (it == agents.end()) [[unlikely]]
+        {
+            LOG_WARNING("Entity is not a steering agent: %d", static_cast<int>(entity));
+            return;
+        }
+        it->second.preferred = velocity;
+    }
+
+    void SteerCompute()
+    {
+        auto& steerData = global::STEER_DATA;
+
+        // Capture the positions upfront - workers only read
+        for (auto& [entity, agent] : steerData.agents)
+        {
+            const auto* pos = ComponentTryGet<PositionC>(entity);
+            const auto* col = ComponentTryGet<CollisionC>(entity);
+            agent.isValid = pos != nullptr && col != nullptr;
+            if (!agent.isValid) [[unlikely]]
+            {
+                agent.velocity = agent.preferred;
+                continue;
+            }
+            agent.position = pos->getMiddle(*col);
+            agent.usedRadius = agent.radius > 0.0F ? agent.radius : GetBoundsRadius(*pos, *col);
+            agent.map = pos->map;
+            global::DY_COLL_DATA.mapEntityGrids[agent.map]; // Make sure the grid exists
+        }
+
+        const int size = static_cast<int>(steerData.agents.size());
+        JobParallelFor(size, 64, ComputeAgentRange);
+
+        // Apply after all are done - the computation uses the velocities of the last tick
+        for (auto& [entity, agent] : steerData.agents)
+        {
+            if (agent.isValid) [[likely]]
+                agent.velocity = agent.newVelocity;
+        }
+    }
+
+    Point SteerGetVelocity(const Entity entity)
+    {
+        const auto& agents = global::STEER_DATA.agents;
+        const auto it = agents.find(entity);
+        if (it == agents.end()) [[unlikely]]
+            return {};
+        return it->second.velocity;
+    }
+
+} // namespace magique
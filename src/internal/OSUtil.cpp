@@ -46,6 +46,8 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #elif __linux__
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <ctime>
@@ -61,8 +63,10 @@
 #include <arpa/inet.h>
 #endif
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
+#include <thread>
 
 #include <raylib/raylib.h>
 #include <magique/util/Logging.h>
@@ -143,6 +147,24 @@ uint64_t GetMemoryWorkingSet()
 #endif
 }
 
+bool OSUtilPinThread(const int core)
+{
+    const int cores = static_cast<int>(std::thread::hardware_concurrency());
+    if (cores == 0) [[unlikely]]
+        return false;
+#ifdef _WIN32
+    const DWORD_PTR mask = static_cast<DWORD_PTR>(1) << (core % std::min(cores, 64));
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cores, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0;
+#else
+    return false; // Unsupported platform (macOS only has affinity hints)
+#endif
+}
+
 static std::string IP_ADDR{};
 
 const char* OSUtilGetLocalIP()
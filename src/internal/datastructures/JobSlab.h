@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#ifndef MAGIQUE_JOB_SLAB_H
+#define MAGIQUE_JOB_SLAB_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <magique/util/JobSystem.h>
+#include <magique/util/Logging.h>
+
+#include "internal/types/SpinLock.h"
+
+//-----------------------------------------------
+// Job Slab
+//-----------------------------------------------
+// .....................................................................
+// Each job occupies a slot - the slot index and a generation make up its handle (JobID)
+// A handle is pending while the slot stores it - finished or stale handles never match again (until 65535 reuses)
+// Small jobs (typical lambda captures) are constructed in the slot directly - bigger ones on the heap
+// The job memory is always preceded by a header that points back to the slot
+// Slots are allocated in chunks that never move - the slab grows by adding chunks
+// Each thread has its own cache of free slots - only refilling or overflowing takes the shared lock
+// .....................................................................
+
+namespace magique
+{
+    struct alignas(internal::JOB_ALIGNMENT) JobHeader final
+    {
+        uint32_t slot = 0;
+        bool isHeap = false;
+    };
+    static_assert(sizeof(JobHeader) == internal::JOB_ALIGNMENT);
+
+    struct alignas(64) JobSlot final
+    {
+        static constexpr int STORAGE_SIZE = 128 - 2 * internal::JOB_ALIGNMENT;
+
+        std::atomic<uint32_t> handle = UINT32_MAX; // Handle of the job in this slot - null if done
+        uint16_t generation = 0;                   // Incremented for each job - makes old handles stale
+        JobHeader header;                          // Directly before the storage
+        alignas(internal::JOB_ALIGNMENT) std::byte storage[STORAGE_SIZE];
+    };
+    // GetHeader() steps back from the job memory - the header has to be directly before the storage
+    static_assert(std::is_standard_layout_v<JobSlot>);
+    static_assert(offsetof(JobSlot, storage) == offsetof(JobSlot, header) + sizeof(JobHeader));
+    static_assert(offsetof(JobSlot, storage) % internal::JOB_ALIGNMENT == 0);
+    static_assert(offsetof(JobSlot, storage) + JobSlot::STORAGE_SIZE == sizeof(JobSlot));
+    static_assert(sizeof(JobSlot) == 128 && alignof(JobSlot) == 64);
+    // Heap jobs are placed after the header - operator new has to align them as well
+    static_assert(internal::JOB_ALIGNMENT <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+    struct JobSlab final
+    {
+        static constexpr int CHUNK_SIZE = 256;
+        static constexpr int MAX_CHUNKS = (UINT16_MAX + 1) / CHUNK_SIZE; // Slot index has 16 bits
+        static constexpr int CACHE_REFILL = 64;                          // Slots taken from the shared list at once
+        static constexpr int CACHE_MAX = 256;                            // Above this half is given back
+
+        struct alignas(64) SlotCache final // Aligned to prevent false sharing
+        {
+            std::vector<uint32_t> free;
+        };
+
+        std::atomic<JobSlot*> chunks[MAX_CHUNKS]{};           // Lookup without locking - never changes once set
+        std::vector<std::unique_ptr<JobSlot[]>> chunkStorage; // Owns the chunks
+        std::vector<uint32_t> sharedFree;                     // Free slots that are not cached by any thread
+        SpinLock sharedLock;                                  // The lock to make shared access thread safe
+        std::unique_ptr<SlotCache[]> cache;                   // Per thread free slots
+
+        // Creates the free slot caches - one for each thread that allocates on its own
+        void init(const int cacheCount) { cache = std::make_unique<SlotCache[]>(cacheCount); }
+
+        JobSlot& get(const uint32_t slot)
+        {
+            return chunks[slot / CHUNK_SIZE].load(std::memory_order_acquire)[slot % CHUNK_SIZE];
+        }
+
+        // Returns the memory for a job of the given size
+        void* allocate(const int cacheIdx, const size_t bytes)
+        {
+            const uint32_t slotIdx = allocateSlot(cache[cacheIdx].free);
+            auto& slot = get(slotIdx);
+            if (bytes <= JobSlot::STORAGE_SIZE) [[likely]]
+            {
+                slot.header = {slotIdx, false};
+                return slot.storage;
+            }
+            auto* memory = static_cast<std::byte*>(::operator new(sizeof(JobHeader) + bytes));
+            new (memory) JobHeader{slotIdx, true};
+            return memory + sizeof(JobHeader);
+        }
+
+        // Frees the memory of the job - the job has to be destroyed already
+        void free(const int cacheIdx, void* job)
+        {
+            auto* header = GetHeader(job);
+            const uint32_t slotIdx = header->slot;
+            if (header->isHeap) [[unlikely]]
+                ::operator delete(header);
+            freeSlot(cache[cacheIdx].free, slotIdx);
+        }
+
+        // Assigns a new handle to the slot of the job
+        JobID assign(const void* job)
+        {
+            const uint32_t slotIdx = GetHeader(job)->slot;
+            auto& slot = get(slotIdx);
+            slot.generation = slot.generation == UINT16_MAX - 1 ? 0 : slot.generation + 1; // Never forms null
+            const uint32_t handle = static_cast<uint32_t>(slot.generation) << 16 | slotIdx;
+            slot.handle.store(handle, std::memory_order_release);
+            return static_cast<JobID>(handle);
+        }
+
+        // Marks the job with the given handle as done
+        void finish(const JobID id) { get(GetSlot(id)).handle.store(UINT32_MAX, std::memory_order_seq_cst); }
+
+        // Returns true if the job with the handle is not done yet - false for stale handles
+        [[nodiscard]] bool isPending(const JobID id, const std::memory_order order = std::memory_order_acquire) const
+        {
+            if (id == JobID::null) [[unlikely]]
+                return false;
+            const auto* chunk = chunks[GetSlot(id) / CHUNK_SIZE].load(std::memory_order_acquire);
+            if (chunk == nullptr) [[unlikely]]
+                return false;
+            return chunk[GetSlot(id) % CHUNK_SIZE].handle.load(order) == static_cast<uint32_t>(id);
+        }
+
+    private:
+        static JobHeader* GetHeader(const void* job)
+        {
+            return reinterpret_cast<JobHeader*>(static_cast<std::byte*>(const_cast<void*>(job)) - sizeof(JobHeader));
+        }
+
+        static uint32_t GetSlot(const JobID id) { return static_cast<uint32_t>(id) & UINT16_MAX; }
+
+        uint32_t allocateSlot(std::vector<uint32_t>& local)
+        {
+            if (local.empty()) [[unlikely]]
+            {
+                SpinLockGuard guard{sharedLock};
+                if (sharedFree.empty())
+                    grow();
+                const auto count = std::min<size_t>(CACHE_REFILL, sharedFree.size());
+                local.insert(local.end(), sharedFree.end() - count, sharedFree.end());
+                sharedFree.resize(sharedFree.size() - count);
+            }
+            const uint32_t slot = local.back();
+            local.pop_back();
+            return slot;
+        }
+
+        void freeSlot(std::vector<uint32_t>& local, const uint32_t slot)
+        {
+            local.push_back(slot);
+            if (local.size() > CACHE_MAX) [[unlikely]] // Jobs are often freed on other threads than allocated
+            {
+                SpinLockGuard guard{sharedLock};
+                const auto count = local.size() / 2;
+                sharedFree.insert(sharedFree.end(), local.end() - count, local.end());
+                local.resize(local.size() - count);
+            }
+        }
+
+        void grow() // Called with the shared lock
+        {
+            const int chunk = static_cast<int>(chunkStorage.size());
+            if (chunk == MAX_CHUNKS) [[unlikely]]
+            {
+                LOG_FATAL("Too many jobs at once: %d", MAX_CHUNKS * CHUNK_SIZE);
+                std::exit(EXIT_FAILURE);
+            }
+            auto& storage = chunkStorage.emplace_back(std::make_unique<JobSlot[]>(CHUNK_SIZE));
+            chunks[chunk].store(storage.get(), std::memory_order_release);
+            for (int i = CHUNK_SIZE - 1; i >= 0; --i) // Reverse so the lowest are used first
+            {
+                sharedFree.push_back(static_cast<uint32_t>(chunk * CHUNK_SIZE + i));
+            }
+        }
+    };
+
+} // namespace magique
+
+#endif // MAGIQUE_JOB_SLAB_H
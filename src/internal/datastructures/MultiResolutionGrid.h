@@ -268,6 +268,25 @@ struct SingleResolutionHashGrid final
         }
     }
 
+    // Same as above but only visits the cells of the given rect - the rect the value was inserted with
+    void removeWithHoles(V val, const float x, const float y, const float w, const float h)
+    {
+        const auto removeFunction = [this, val](const int cellX, const int cellY)
+        {
+            const auto it = cellMap.find(GetCellID(cellX, cellY));
+            if (it == cellMap.end())
+                return;
+            DataBlock<V, blockSize>* start = &dataBlocks[it->second];
+            start->remove(val);
+            while (start->hasNext())
+            {
+                start = &dataBlocks[start->next];
+                start->remove(val);
+            }
+        };
+        RasterizeRect<cellSize>(removeFunction, x, y, w, h);
+    }
+
     template <typename T, typename Pred>
     void removeIfWithHoles(T val, Pred pred)
     {
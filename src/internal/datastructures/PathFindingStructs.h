@@ -2,17 +2,22 @@
 #define PATHFINDINGSTRUCTS_H
 
 #include <bitset>
+#include <list>
 #include "magique/util/Datastructures.h"
+#include "magique/gamedev/PathFinding.h"
 
 namespace magique
 {
-    inline constexpr std::array<PathFindHeuristicFunc, 2> PATH_HEURISTICS = {
+    // Indexed by GridMode - ANY searches like STAR and removes the redundant points after
+    inline constexpr std::array<PathFindHeuristicFunc, 3> PATH_HEURISTICS = {
         [](const Point& curr, const Point& end) { return curr.manhattan(end) * 1.1F; },
         [](const Point& curr, const Point& end) { return curr.chebyshev(end) * 1.1F; },
+        [](const Point& curr, const Point& end) { return curr.chebyshev(end) * 1.1F; },
     };
-    inline constexpr std::array<PathFindMoveCostFunc, 2> MOVE_COST = {
+    inline constexpr std::array<PathFindMoveCostFunc, 3> MOVE_COST = {
         [](const Point& dir) { return 1.0F; },
         [](const Point& dir) { return dir.x != 0 && dir.y != 0 ? 1.40F : 1.0F; },
+        [](const Point& dir) { return dir.x != 0 && dir.y != 0 ? 1.40F : 1.0F; },
     };
 
     inline std::array MOVEMENTS = {StackVector<Point, 8>{
@@ -21,6 +26,16 @@ namespace magique
                                        {0, 1},       // South
                                        {-1, 0},      // West
                                    },
+                                   StackVector<Point, 8>{
+                                       Point{0, -1}, // North
+                                       {1, -1},      // North-East
+                                       {1, 0},       // East
+                                       {1, 1},       // South-East
+                                       {0, 1},       // South
+                                       {-1, 1},      // South-West
+                                       {-1, 0},      // West
+                                       {-1, -1}      // North-West
+                                   },
                                    StackVector<Point, 8>{
                                        Point{0, -1}, // North
                                        {1, -1},      // North-East
@@ -63,6 +78,13 @@ namespace magique
         return (static_cast<VisitedCellID>(first) << 16) | second;
     }
 
+    // Reverses GetVisitedCellID() - returns the cell coordinates
+    inline void GetVisitedCellPos(const VisitedCellID id, int& cellX, int& cellY)
+    {
+        cellX = static_cast<int16_t>(id >> 16);
+        cellY = static_cast<int16_t>(id & UINT16_MAX);
+    }
+
     template <int mainGridBaseSize>
     struct DenseLookupGrid final
     {
@@ -95,6 +117,181 @@ namespace magique
         void clear() { visited.clear(); }
     };
 
+    // Stores the distance (chebyshev, in cells) to the closest solid cell - capped at MAX_CLEARANCE
+    // Only cells close to a solid cell are stored - all other cells have the maximum clearance
+    // A cell with clearance n fits a square agent spanning (2 * n - 1) cells centered on it
+    struct ClearanceGrid final
+    {
+        static constexpr uint8_t MAX_CLEARANCE = 8;
+        static constexpr int RANGE = MAX_CLEARANCE - 1; // Cells a solid cell lowers the clearance of on each side
+        HashMap<VisitedCellID, uint8_t> cells{};
+        bool isBuilt = false; // Used to build the static clearance together with the static grid
+
+        // Only used by the dynamic clearance - it's updated incrementally from the solid cells of the last sync
+        HashSet<VisitedCellID> solids{};
+        HashSet<VisitedCellID> affected{};   // Cells whose clearance is recomputed
+        HashSet<VisitedCellID> candidates{}; // Solid cells that can lower an affected cell
+        std::vector<VisitedCellID> changed{};
+        uint32_t syncedEpoch = UINT32_MAX; // Dynamic grid epoch the clearance is from
+
+        [[nodiscard]] uint8_t getClearance(const int cellX, const int cellY) const
+        {
+            const auto it = cells.find(GetVisitedCellID(cellX, cellY));
+            return it == cells.end() ? MAX_CLEARANCE : it->second;
+        }
+
+        // Lowers the clearance of all cells within range of the given solid cell
+        void addSolid(const int cellX, const int cellY)
+        {
+            for (int i = -RANGE; i <= RANGE; ++i)
+            {
+                for (int j = -RANGE; j <= RANGE; ++j)
+                {
+                    const auto dist = static_cast<uint8_t>(std::max(std::abs(i), std::abs(j)));
+                    lowerClearance(GetVisitedCellID(cellX + j, cellY + i), dist);
+                }
+            }
+        }
+
+        // Only cells on the border of a solid area can be the closest solid cell to a free cell
+        template <int size>
+        void build(const DenseLookupGrid<size>& grid)
+        {
+            for (const auto& [id, val] : grid.visited)
+            {
+                int x, y;
+                GetVisitedCellPos(id, x, y);
+                if (IsInterior(grid, x, y))
+                {
+                    cells[id] = 0;
+                    continue;
+                }
+                addSolid(x, y);
+            }
+            isBuilt = true;
+        }
+
+        // Brings the clearance up to date with the given grid - only recomputes the cells around changed solid cells
+        template <int size>
+        void sync(const DenseLookupGrid<size>& grid, const uint32_t epoch)
+        {
+            if (syncedEpoch == epoch)
+                return;
+            syncedEpoch = epoch;
+
+            changed.clear();
+            for (const auto& [id, val] : grid.visited)
+            {
+                if (!solids.contains(id))
+                    changed.push_back(id);
+            }
+            for (const auto id : solids)
+            {
+                if (!grid.visited.contains(id))
+                    changed.push_back(id);
+            }
+            if (changed.empty())
+                return;
+
+            solids.clear();
+            for (const auto& [id, val] : grid.visited)
+            {
+                solids.insert(id);
+            }
+
+            // Each changed cell scans a window of (4 * RANGE + 1)^2 cells - rebuilding is cheaper if many changed
+            if (changed.size() * 4 > solids.size())
+            {
+                cells.clear();
+                build(grid);
+                return;
+            }
+
+            affected.clear();
+            for (const auto id : changed)
+            {
+                int x, y;
+                GetVisitedCellPos(id, x, y);
+                for (int i = -RANGE; i <= RANGE; ++i)
+                {
+                    for (int j = -RANGE; j <= RANGE; ++j)
+                    {
+                        const auto cell = GetVisitedCellID(x + j, y + i);
+                        if (affected.insert(cell).second)
+                            cells.erase(cell);
+                    }
+                }
+            }
+
+            // Solid cells within range of an affected cell lower it again - each solid cell once
+            candidates.clear();
+            for (const auto id : changed)
+            {
+                int x, y;
+                GetVisitedCellPos(id, x, y);
+                for (int i = -2 * RANGE; i <= 2 * RANGE; ++i)
+                {
+                    for (int j = -2 * RANGE; j <= 2 * RANGE; ++j)
+                    {
+                        const int solidX = x + j;
+                        const int solidY = y + i;
+                        const auto solid = GetVisitedCellID(solidX, solidY);
+                        if (!solids.contains(solid) || !candidates.insert(solid).second)
+                            continue;
+                        if (IsInterior(grid, solidX, solidY))
+                        {
+                            if (affected.contains(solid))
+                                cells[solid] = 0;
+                            continue;
+                        }
+                        addSolidAffected(solidX, solidY);
+                    }
+                }
+            }
+        }
+
+        void clear()
+        {
+            cells.clear();
+            solids.clear();
+            isBuilt = false;
+            syncedEpoch = UINT32_MAX;
+        }
+
+    private:
+        // Same as addSolid() but only lowers the cells that are recomputed
+        void addSolidAffected(const int cellX, const int cellY)
+        {
+            for (int i = -RANGE; i <= RANGE; ++i)
+            {
+                for (int j = -RANGE; j <= RANGE; ++j)
+                {
+                    const auto id = GetVisitedCellID(cellX + j, cellY + i);
+                    if (affected.contains(id))
+                        lowerClearance(id, static_cast<uint8_t>(std::max(std::abs(i), std::abs(j))));
+                }
+            }
+        }
+
+        void lowerClearance(const VisitedCellID id, const uint8_t dist)
+        {
+            const auto [it, inserted] = cells.try_emplace(id, dist);
+            if (!inserted && dist < it->second)
+            {
+                it->second = dist;
+            }
+        }
+
+        template <int size>
+        static bool IsInterior(const DenseLookupGrid<size>& grid, const int x, const int y)
+        {
+            const auto isMarked = [&](const int cx, const int cy)
+            { return grid.visited.contains(GetVisitedCellID(cx, cy)); };
+            return isMarked(x - 1, y - 1) && isMarked(x, y - 1) && isMarked(x + 1, y - 1) && isMarked(x - 1, y) &&
+                isMarked(x + 1, y) && isMarked(x - 1, y + 1) && isMarked(x, y + 1) && isMarked(x + 1, y + 1);
+        }
+    };
+
     // Lookup grid that takes all given positions relative to its center
     // This works good inside a single search - cleared between each search
     // Allows very fast lookups without a hashmap
@@ -140,6 +337,183 @@ namespace magique
         void clear() { std::memset(rows, 0, size * size * sizeof(T)); }
     };
 
+    // A queued path search - slots are reused and identified by their generation
+    struct PathRequest final
+    {
+        std::vector<Point> path;
+        Rect area;                // Sample area for random targets
+        Point start;              // World position
+        Point target;             // World position - chosen position for random targets
+        uint16_t generation = 0;  // Incremented each time the slot is released
+        uint16_t maxLen = 50;     // Maximum path length
+        uint16_t samples = 0;     // Remaining positions to try for random targets - 0 for normal requests
+        GridMode mode = GridMode::STAR;
+        uint8_t clearance = 1;
+        MapID map{};
+        PathStatus status = PathStatus::INVALID; // INVALID if the slot is free
+
+        static uint16_t GetIndex(PathRequestID id) { return static_cast<uint32_t>(id) & UINT16_MAX; }
+        static uint16_t GetGeneration(PathRequestID id) { return static_cast<uint32_t>(id) >> 16; }
+        [[nodiscard]] PathRequestID getID(const uint16_t index) const
+        {
+            return static_cast<PathRequestID>((static_cast<uint32_t>(generation) << 16) | index);
+        }
+    };
+
+    // Tracks changes of the solid cells of a map - used to invalidate cached paths
+    //      - static : a single version for the whole map - the static grid is always rebuilt as a whole
+    //      - dynamic: a version per region - bumped if the dynamic solid cells inside the region changed
+    struct PathRegionVersions final
+    {
+        static constexpr int REGION_SIZE = 16; // Cells per side
+        HashMap<uint32_t, uint32_t> versions{};   // Region -> version
+        HashMap<uint32_t, uint64_t> signatures{}; // Region -> hash of the dynamic solid cells inside
+        HashMap<uint32_t, uint64_t> scratch{};
+        uint32_t staticVersion = 0;
+        uint32_t syncedEpoch = UINT32_MAX; // Dynamic grid epoch the signatures are from
+
+        static int GetRegion(const int cell) { return floordiv<REGION_SIZE>(static_cast<float>(cell)); }
+
+        // Compares the dynamic grid to the last seen state and bumps the changed regions
+        template <int size>
+        void sync(const DenseLookupGrid<size>& grid, const uint32_t epoch)
+        {
+            if (syncedEpoch == epoch)
+                return;
+            syncedEpoch = epoch;
+            scratch.clear();
+            for (const auto& [id, val] : grid.visited)
+            {
+                int x, y;
+                GetVisitedCellPos(id, x, y);
+                // Order independent so the iteration order doesn't matter
+                scratch[GetVisitedCellID(GetRegion(x), GetRegion(y))] += ankerl::unordered_dense::hash<uint32_t>{}(id);
+            }
+            for (const auto& [region, signature] : scratch)
+            {
+                const auto it = signatures.find(region);
+                if (it == signatures.end() || it->second != signature)
+                    versions[region]++;
+            }
+            for (const auto& [region, signature] : signatures)
+            {
+                if (!scratch.contains(region))
+                    versions[region]++;
+            }
+            std::swap(signatures, scratch);
+        }
+
+        // Region is packed like VisitedCellID
+        [[nodiscard]] uint32_t getVersion(const uint32_t region) const
+        {
+            const auto it = versions.find(region);
+            return it == versions.end() ? 0 : it->second;
+        }
+
+        // Returns the sum of all region versions in the given region rectangle - changes if any of them changed
+        [[nodiscard]] uint64_t getVersionSum(const int minX, const int minY, const int maxX, const int maxY) const
+        {
+            uint64_t sum = 0;
+            for (int i = minY; i <= maxY; ++i)
+            {
+                for (int j = minX; j <= maxX; ++j)
+                {
+                    const auto it = versions.find(GetVisitedCellID(j, i));
+                    if (it != versions.end())
+                        sum += it->second;
+                }
+            }
+            return sum;
+        }
+    };
+
+    // Identifies a cached path - cells are packed like VisitedCellID
+    struct PathCacheKey final
+    {
+        uint32_t start;
+        uint32_t end;
+        uint16_t maxLen;
+        MapID map;
+        GridMode mode;
+        uint8_t clearance;
+
+        bool operator==(const PathCacheKey& o) const = default;
+    };
+
+    struct PathCacheKeyHash final
+    {
+        uint64_t operator()(const PathCacheKey& key) const
+        {
+            const uint64_t cells = (static_cast<uint64_t>(key.start) << 32) | key.end;
+            const uint64_t params = (static_cast<uint64_t>(key.maxLen) << 24) |
+                (static_cast<uint64_t>(key.map) << 16) | (static_cast<uint64_t>(key.mode) << 8) | key.clearance;
+            constexpr ankerl::unordered_dense::hash<uint64_t> hash{};
+            return hash(cells) ^ (hash(params) * 31U);
+        }
+    };
+
+    struct PathCacheEntry final
+    {
+        PathCacheKey key;
+        std::vector<Point> path;
+        uint64_t regionVersion; // Sum of the covered region versions when cached
+        uint32_t staticVersion;
+        int16_t minX, minY, maxX, maxY; // Covered regions
+        bool reached;
+    };
+
+    // Least recently used cache of search results - most recently used at the front
+    struct PathCache final
+    {
+        std::list<PathCacheEntry> entries;
+        HashMapEx<PathCacheKey, std::list<PathCacheEntry>::iterator, PathCacheKeyHash, std::equal_to<>> lookup;
+        int capacity = 0; // Disabled by default
+
+        PathCacheEntry* get(const PathCacheKey& key)
+        {
+            const auto it = lookup.find(key);
+            if (it == lookup.end())
+                return nullptr;
+            entries.splice(entries.begin(), entries, it->second);
+            return &*it->second;
+        }
+
+        PathCacheEntry& add(const PathCacheKey& key)
+        {
+            if (static_cast<int>(entries.size()) >= capacity) // Reuse the least recently used entry
+            {
+                entries.splice(entries.begin(), entries, std::prev(entries.end()));
+                lookup.erase(entries.front().key);
+            }
+            else
+            {
+                entries.emplace_front();
+            }
+            auto& entry = entries.front();
+            entry.key = key;
+            lookup[key] = entries.begin();
+            return entry;
+        }
+
+        void erase(const PathCacheKey& key)
+        {
+            const auto it = lookup.find(key);
+            if (it == lookup.end())
+                return;
+            entries.erase(it->second);
+            lookup.erase(it);
+        }
+
+        void setCapacity(const int entryCount)
+        {
+            capacity = std::max(entryCount, 0);
+            while (static_cast<int>(entries.size()) > capacity)
+            {
+                lookup.erase(entries.back().key);
+                entries.pop_back();
+            }
+        }
+    };
 
 } // namespace magique
 #endif // PATHFINDINGSTRUCTS_H
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#ifndef MAGIQUE_REGION_INDEX_H
+#define MAGIQUE_REGION_INDEX_H
+
+#include <span>
+#include <vector>
+#include <algorithm>
+#include <magique/core/Types.h>
+#include <magique/util/Datastructures.h>
+
+#include "internal/datastructures/MultiResolutionGrid.h"
+
+//-----------------------------------------------
+// Entity Region Index
+//-----------------------------------------------
+// .....................................................................
+// Entities are binned into coarse region chunks per map by their position
+// Only chunks that intersect an active rect (camera, actor update rects) are visited each tick - dormant areas are not
+// Visited entities are re-binned when they changed their chunk - dormant ones by a rolling sweep over all entities
+// Entities moved with EntitySetPosition() are re-binned before visiting - so they are visited in their new area
+// Entities of a chunk are stored densely - each entity knows its chunk and slot so moving and removing is O(1)
+// .....................................................................
+
+namespace magique
+{
+    struct EntityRegionIndex final
+    {
+        static constexpr int CHUNK_SIZE = 1024;            // Pixels - coarse so only few chunks are visited
+        static constexpr float MARGIN = CHUNK_SIZE / 4.0F; // Rects are enlarged - binned by position not middle
+        static constexpr int SWEEP_TICKS = 30;             // Each entity is re-binned at least this often
+
+        struct Location final
+        {
+            CellID chunk = 0;
+            uint32_t slot = UINT32_MAX; // Index in the chunk - UINT32_MAX if not indexed
+            MapID map{};
+        };
+
+        struct MapRegions final
+        {
+            HashMap<CellID, std::vector<Entity>> chunks;
+            int count = 0; // Entities in this map
+        };
+
+        MapRegions maps[UINT8_MAX];        // Regions per map
+        std::vector<Location> locations;   // Indexed by the entity index
+        std::vector<CellID> visitChunks;   // Chunks to visit - cached to avoid allocations
+        std::vector<Entity> movedEntities; // Entities that changed their chunk while visiting
+        std::vector<Entity> touched;       // Entities moved outside the tick - re-binned before the next visit
+        uint32_t sweepCursor = 0;          // Next entity of the rolling sweep
+
+        static CellID GetChunk(const Point pos)
+        {
+            return GetCellID(floordiv<CHUNK_SIZE>(pos.x), floordiv<CHUNK_SIZE>(pos.y));
+        }
+
+        static uint32_t GetIndex(const Entity entity) { return static_cast<uint32_t>(entt::to_entity(entity)); }
+
+        void insert(const Entity entity, const Point pos, const MapID map)
+        {
+            const auto index = GetIndex(entity);
+            if (index >= locations.size())
+                locations.resize(index + 1);
+            auto& location = locations[index];
+            MAGIQUE_ASSERT(location.slot == UINT32_MAX, "Entity is already indexed");
+            auto& regions = maps[static_cast<int>(map)];
+            auto& chunk = regions.chunks[GetChunk(pos)];
+            location = {GetChunk(pos), static_cast<uint32_t>(chunk.size()), map};
+            chunk.push_back(entity);
+            ++regions.count;
+        }
+
+        void remove(const Entity entity)
+        {
+            const auto index = GetIndex(entity);
+            if (index >= locations.size() || locations[index].slot == UINT32_MAX) [[unlikely]]
+                return;
+            auto& location = locations[index];
+            auto& regions = maps[static_cast<int>(location.map)];
+            auto& chunk = regions.chunks[location.chunk];
+            const auto last = chunk.back(); // Swap with the last
+            chunk[location.slot] = last;
+            locations[GetIndex(last)].slot = location.slot;
+            chunk.pop_back();
+            if (chunk.empty())
+                regions.chunks.erase(location.chunk);
+            --regions.count;
+            location.slot = UINT32_MAX;
+        }
+
+        // Moves the entity if its map or chunk changed - inserts it if it's not indexed
+        void update(const Entity entity, const Point pos, const MapID map)
+        {
+            if (!hasMoved(entity, pos, map)) [[likely]]
+                return;
+            remove(entity);
+            insert(entity, pos, map);
+        }
+
+        // Returns true if the entity is not indexed in the chunk of the given position
+        [[nodiscard]] bool hasMoved(const Entity entity, const Point pos, const MapID map) const
+        {
+            const auto index = GetIndex(entity);
+            if (index >= locations.size() || locations[index].slot == UINT32_MAX) [[unlikely]]
+                return true;
+            const auto& location = locations[index];
+            return location.map != map || location.chunk != GetChunk(pos);
+        }
+
+        void clear()
+        {
+            for (auto& regions : maps)
+            {
+                regions.chunks.clear();
+                regions.count = 0;
+            }
+            locations.clear();
+            touched.clear();
+            sweepCursor = 0;
+        }
+
+        [[nodiscard]] int getCount(const MapID map) const { return maps[static_cast<int>(map)].count; }
+
+        // Calls func(entity) for each entity in the chunks that intersect any of the rects - each entity once
+        // Entities must not be added or removed while visiting
+        template <typename Func>
+        void forEach(const MapID map, const std::span<const Rect> rects, const Func& func)
+        {
+            const auto& regions = maps[static_cast<int>(map)];
+            if (regions.count == 0)
+                return;
+            visitChunks.clear();
+            for (const auto& rect : rects)
+            {
+                const int x1 = floordiv<CHUNK_SIZE>(rect.x - MARGIN);
+                const int y1 = floordiv<CHUNK_SIZE>(rect.y - MARGIN);
+                const int x2 = floordiv<CHUNK_SIZE>(rect.x + rect.width + MARGIN);
+                const int y2 = floordiv<CHUNK_SIZE>(rect.y + rect.height + MARGIN);
+                for (int y = y1; y <= y2; ++y)
+                {
+                    for (int x = x1; x <= x2; ++x)
+                    {
+                        visitChunks.push_back(GetCellID(x, y));
+                    }
+                }
+            }
+            std::ranges::sort(visitChunks); // Rects can overlap
+            const auto [first, last] = std::ranges::unique(visitChunks);
+            visitChunks.erase(first, last);
+            for (const auto id : visitChunks)
+            {
+                const auto it = regions.chunks.find(id);
+                if (it == regions.chunks.end())
+                    continue;
+                for (const auto entity : it->second)
+                {
+                    func(entity);
+                }
+            }
+        }
+    };
+
+} // namespace magique
+
+#endif // MAGIQUE_REGION_INDEX_H
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#ifndef MAGIQUE_TYPE_INDEX_H
+#define MAGIQUE_TYPE_INDEX_H
+
+#include <span>
+#include <vector>
+#include <magique/core/Types.h>
+
+//-----------------------------------------------
+// Entity Type Index
+//-----------------------------------------------
+// .....................................................................
+// Entities stored densely per entity type - type filtered loops only visit entities of that type
+// Each entity knows its type and slot so removing is O(1) (swaps with the last)
+// The type is saved on insertion - changing PositionC::type afterward does not move the entity
+// .....................................................................
+
+namespace magique
+{
+    struct EntityTypeIndex final
+    {
+        struct Location final
+        {
+            uint32_t slot = UINT32_MAX; // Index in the type - UINT32_MAX if not indexed
+            EntityType type{};
+        };
+
+        std::vector<std::vector<Entity>> types; // Indexed by the entity type
+        std::vector<Location> locations;        // Indexed by the entity index
+
+        static uint32_t GetIndex(const Entity entity) { return static_cast<uint32_t>(entt::to_entity(entity)); }
+
+        void insert(const Entity entity, const EntityType type)
+        {
+            const auto index = GetIndex(entity);
+            if (index >= locations.size())
+                locations.resize(index + 1);
+            const auto typeNum = static_cast<int>(type);
+            if (typeNum >= static_cast<int>(types.size())) [[unlikely]]
+                types.resize(typeNum + 1);
+            auto& location = locations[index];
+            MAGIQUE_ASSERT(location.slot == UINT32_MAX, "Entity is already indexed");
+            auto& entities = types[typeNum];
+            location = {static_cast<uint32_t>(entities.size()), type};
+            entities.push_back(entity);
+        }
+
+        void remove(const Entity entity)
+        {
+            const auto index = GetIndex(entity);
+            if (index >= locations.size() || locations[index].slot == UINT32_MAX) [[unlikely]]
+                return;
+            auto& location = locations[index];
+            auto& entities = types[static_cast<int>(location.type)];
+            const auto last = entities.back(); // Swap with the last
+            entities[location.slot] = last;
+            locations[GetIndex(last)].slot = location.slot;
+            entities.pop_back();
+            location.slot = UINT32_MAX;
+        }
+
+        void clear()
+        {
+            for (auto& entities : types)
+            {
+                entities.clear();
+            }
+            locations.clear();
+        }
+
+        [[nodiscard]] std::span<const Entity> get(const EntityType type) const
+        {
+            const auto typeNum = static_cast<int>(type);
+            if (typeNum >= static_cast<int>(types.size()))
+                return {};
+            return types[typeNum];
+        }
+
+        // Types are in [0, getTypeCount())
+        [[nodiscard]] int getTypeCount() const { return static_cast<int>(types.size()); }
+    };
+
+} // namespace magique
+
+#endif // MAGIQUE_TYPE_INDEX_H
@@ -16,8 +16,8 @@ namespace magique
         Entity e2;
     };
 
-    using CollPairCollector = AlignedVec<PairInfo>[MAGIQUE_WORKER_THREADS + 1];
-    using EntityCollector = AlignedVec<Entity>[MAGIQUE_WORKER_THREADS + 1];
+    using CollPairCollector = std::vector<AlignedVec<PairInfo>>; // One per thread - sized on init
+    using EntityCollector = std::vector<AlignedVec<Entity>>;
     using EntityHashGrid = SingleResolutionHashGrid<Entity, MAGIQUE_MAX_ENTITIES_CELL, MAGIQUE_COLLISION_CELL_SIZE>;
 
     struct DynamicCollisionData final
@@ -25,9 +25,29 @@ namespace magique
         MapHolder<EntityHashGrid> mapEntityGrids{}; // Separate hashgrid for each map
         HashSet<uint64_t> pairSet;                  // Filters unique collision pairs
         CollPairCollector collisionPairs{};         // Collision pair collectors
+        std::vector<Rect> gridBounds;               // Bounds the entity was inserted with - indexed by entity index
 
         DynamicCollisionData() { pairSet.reserve(1000); }
 
+        void insertEntity(const Entity e, const Rect& bb, EntityHashGrid& grid)
+        {
+            const auto index = static_cast<uint32_t>(entt::to_entity(e));
+            if (index >= gridBounds.size()) [[unlikely]]
+                gridBounds.resize(index + 1);
+            gridBounds[index] = bb;
+            grid.insert(e, bb.x, bb.y, bb.width, bb.height);
+        }
+
+        // Only visits the cells the entity was inserted into - does nothing if it's not in the grid
+        void removeEntity(const Entity e, const MapID map)
+        {
+            const auto index = static_cast<uint32_t>(entt::to_entity(e));
+            if (index >= gridBounds.size() || !mapEntityGrids.contains(map))
+                return;
+            const auto& bb = gridBounds[index];
+            mapEntityGrids[map].removeWithHoles(e, bb.x, bb.y, bb.width, bb.height);
+        }
+
         bool isMarked(Entity e1, uint32_t e2)
         {
             const auto num = (static_cast<uint64_t>(e1) << 32) | e2;
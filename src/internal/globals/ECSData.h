@@ -3,13 +3,28 @@
 #define MAGIQUE_ECSDATA_H
 
 #include <magique/util/Datastructures.h>
+#include <magique/ecs/ECS.h>
+
+#include "internal/datastructures/TypeIndex.h"
 
 namespace magique
 {
+    // Components captured from a prototype of a type - copied to entities created in a batch
+    struct Archetype final
+    {
+        std::vector<std::unique_ptr<internal::IArchetypeComponent>> components;
+        PositionC position{}; // Changes in the create function are kept - except pos, map and rotation
+        bool isScripted = true;
+        bool isBatchable = false; // False if the type has to be created one by one
+    };
+
     struct ECSData final
     {
+        static constexpr auto PROTOTYPE_ID = static_cast<Entity>(0); // Never handed out - ids start at 1
         uint32_t entityID = 1;
         HashMap<EntityType, CreateFunc> typeMap{50};
+        EntityTypeIndex typeIndex; // All entities by their type
+        HashMap<EntityType, Archetype> archetypes; // Captured on the first batch creation
     };
 
     namespace global
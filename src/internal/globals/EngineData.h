@@ -8,6 +8,8 @@
 #include <magique/util/Datastructures.h>
 #include <magique/ecs/ECS.h>
 
+#include "internal/datastructures/RegionIndex.h"
+
 //-----------------------------------------------
 // Engine Data
 //-----------------------------------------------
@@ -17,8 +19,6 @@
 
 namespace magique
 {
-    static constexpr int COL_WORK_PARTS = MAGIQUE_WORKER_THREADS + 1; // Amount of parts to split collision work into
-
     struct CameraShakeData final
     {
         Point offset;
@@ -29,6 +29,132 @@ namespace magique
         bool up;
     };
 
+    // Tracks until which tick entities are updated - stored densely by the entity index so no hashing is needed
+    struct EntityUpdateCache final
+    {
+        struct Record final
+        {
+            uint32_t activeUntil = 0;   // Entity is updated while the engine ticks are below this
+            uint32_t slot = UINT32_MAX; // Index in the cached entities - UINT32_MAX if not cached
+        };
+
+        std::vector<Record> records; // Indexed by the entity index
+        std::vector<Entity> cached;  // All cached entities
+
+        static uint32_t GetIndex(const Entity entity) { return static_cast<uint32_t>(entt::to_entity(entity)); }
+
+        void add(const Entity entity, const uint32_t untilTick)
+        {
+            const auto index = GetIndex(entity);
+            if (index >= records.size()) [[unlikely]]
+                records.resize(index + 1);
+            auto& record = records[index];
+            record.activeUntil = untilTick;
+            if (record.slot == UINT32_MAX)
+            {
+                record.slot = static_cast<uint32_t>(cached.size());
+                cached.push_back(entity);
+            }
+        }
+
+        void remove(const Entity entity)
+        {
+            const auto index = GetIndex(entity);
+            if (index >= records.size() || records[index].slot == UINT32_MAX)
+                return;
+            removeSlot(records[index].slot);
+        }
+
+        [[nodiscard]] bool contains(const Entity entity, const uint32_t tick) const
+        {
+            const auto index = GetIndex(entity);
+            if (index >= records.size()) [[unlikely]]
+                return false;
+            const auto& record = records[index];
+            return record.slot != UINT32_MAX && record.activeUntil > tick;
+        }
+
+        void clear()
+        {
+            for (const auto entity : cached)
+            {
+                records[GetIndex(entity)] = {};
+            }
+            cached.clear();
+        }
+
+        // Removes the expired entities and appends the others to the vector
+        void collect(const uint32_t tick, std::vector<Entity>& updateVec)
+        {
+            for (uint32_t i = 0; i < cached.size();)
+            {
+                const auto entity = cached[i];
+                if (records[GetIndex(entity)].activeUntil > tick)
+                {
+                    updateVec.push_back(entity);
+                    ++i;
+                }
+                else
+                {
+                    removeSlot(i); // Swaps in the last - check the same slot again
+                }
+            }
+        }
+
+    private:
+        void removeSlot(const uint32_t slot)
+        {
+            const auto entity = cached[slot];
+            const auto last = cached.back();
+            cached[slot] = last;
+            records[GetIndex(last)].slot = slot;
+            cached.pop_back();
+            records[GetIndex(entity)] = {};
+        }
+    };
+
+    // Slots of the entities in one of the per tick vectors - built on the first removal after the vector was filled
+    // Removes in O(1) by swapping with the last entity - the order of the vector is not kept
+    struct EntitySlotIndex final
+    {
+        std::vector<uint32_t> slots; // Indexed by the entity index - verified against the vector before use
+        bool isBuilt = false;
+
+        static uint32_t GetIndex(const Entity entity) { return static_cast<uint32_t>(entt::to_entity(entity)); }
+
+        // Has to be called when the vector is refilled
+        void invalidate() { isBuilt = false; }
+
+        void remove(std::vector<Entity>& vec, const Entity entity)
+        {
+            if (!isBuilt) [[unlikely]]
+                build(vec);
+            const auto index = GetIndex(entity);
+            if (index >= slots.size())
+                return;
+            const auto slot = slots[index];
+            if (slot >= vec.size() || vec[slot] != entity) // Not contained - slot is from an earlier build
+                return;
+            const auto last = vec.back();
+            vec[slot] = last;
+            slots[GetIndex(last)] = slot;
+            vec.pop_back();
+        }
+
+    private:
+        void build(const std::vector<Entity>& vec)
+        {
+            for (uint32_t i = 0; i < vec.size(); ++i)
+            {
+                const auto index = GetIndex(vec[i]);
+                if (index >= slots.size())
+                    slots.resize(index + 1);
+                slots[index] = i;
+            }
+            isBuilt = true;
+        }
+    };
+
     struct EngineData final
     {
         // Callbacks
@@ -37,14 +163,18 @@ namespace magique
         EntityCallback createCallback;
 
         // Datastructures
-        HashMap<Entity, uint16_t> entityUpdateCache; // Maps entity to cache duration
+        EntityUpdateCache entityUpdateCache;         // Entities that are updated and until which tick
         HashSet<Entity> entityNScriptedSet;          // Contains all entities NOT scripted
         std::vector<Entity> entityUpdateVec;         // Vector containing the entities to update for this tick
         std::vector<Entity> drawVec;                 // Vector containing all entities to be drawn this tick
         std::vector<MapID> loadedMaps{};             // Currently loaded zones
         std::vector<Entity> collisionVec;            // Vector containing the entities to check for collision
         std::vector<Entity> deferredDestroyVec;      // Contains all entities to be destroyed at the end of tick
+        EntitySlotIndex drawSlots;                   // Slots in the drawVec
+        EntitySlotIndex updateSlots;                 // Slots in the entityUpdateVec
+        EntitySlotIndex collisionSlots;              // Slots in the collisionVec
         HashSet<Entity> queryCache;
+        EntityRegionIndex regionIndex;               // Entities binned into region chunks - only active are visited
 
         CameraShakeData cameraShake{};      // Data about the current camera shake
         Camera2D camera{};                  // Current camera
@@ -59,7 +189,7 @@ namespace magique
         void init()
         {
             camera.zoom = 1.0F;
-            entityUpdateCache.reserve(1000);
+            entityUpdateCache.cached.reserve(1000);
             drawVec.reserve(1000);
             entityUpdateVec.reserve(1000);
             collisionVec.reserve(500);
@@ -68,6 +198,22 @@ namespace magique
         void update() { internal::CameraUpdateShake(); }
 
         [[nodiscard]] bool isEntityScripted(const Entity e) const { return !entityNScriptedSet.contains(e); }
+
+        // Removes the entity from the per tick vectors
+        void removeFromTickVecs(const Entity e)
+        {
+            drawSlots.remove(drawVec, e);
+            updateSlots.remove(entityUpdateVec, e);
+            collisionSlots.remove(collisionVec, e);
+        }
+
+        // Has to be called when the per tick vectors are refilled
+        void invalidateSlots()
+        {
+            drawSlots.invalidate();
+            updateSlots.invalidate();
+            collisionSlots.invalidate();
+        }
     };
 
     namespace global
@@ -2,68 +2,597 @@
 #ifndef MAGIQUE_JOB_SCHEDULER_H
 #define MAGIQUE_JOB_SCHEDULER_H
 
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <coroutine>
 #include <deque>
+#include <memory>
+#include <span>
 #include <thread>
 #include <raylib/raylib.h>
 
+#include <magique/util/Datastructures.h>
+
 #include "internal/utils/OSUtil.h"
 #include "internal/types/SpinLock.h"
-#include "external/cxstructs/cxallocator/SlotAllocator.h"
+#include "internal/datastructures/JobSlab.h"
+
+//-----------------------------------------------
+// Job Scheduler
+//-----------------------------------------------
+// .....................................................................
+// Each worker owns a work stealing deque (Chase-Lev) - only the owner pushes and pops at the bottom
+// Idle workers steal from the top of the other deques
+// Other threads (e.g. main thread) can't push to a deque - their jobs are spread round-robin into the worker inboxes
+// Idle workers also take from the inboxes of others so no job waits for a busy worker
+// Completion is tracked with the handle stored in the job slot - no locks needed to await
+// Jobs with dependencies are held back until their wait count reaches 0 - each finished dependency decrements it
+// Continuations are only looked up on completion if any are registered at all
+// The amount of workers is set on init - with 0 threads there is a single inbox that is worked on the main thread
+// Idle workers spin shortly and then park on a futex (atomic wait) - submitting a job wakes a parked worker
+// Between ticks (hibernate) workers stay parked until woken up by the main thread
+// Delayed jobs wait in a min-heap and are released into the queues when due - they never block ready jobs
+// Awaiting threads execute queued jobs while waiting - nested awaits can't deadlock and the waiter isn't idle
+// Suspended coroutines (JobTask) are resumed as jobs or from the main thread lists - their frames come from a pool
+// Main thread jobs wait in a queue per priority - the render tick executes them until its time budget is used up
+// .....................................................................
 
 namespace magique
 {
+    // Index of the worker the current thread is - -1 if it's not a worker (e.g. main thread)
+    inline thread_local int WORKER_INDEX = -1;
+
+    // Lock-free work stealing deque - based on "Correct and Efficient Work-Stealing for Weak Memory Models"
+    struct WorkStealingDeque final
+    {
+        static constexpr int64_t CAPACITY = 1024; // Power of two
+        static constexpr int64_t MASK = CAPACITY - 1;
+
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        alignas(64) std::atomic<IJob*> buffer[CAPACITY]{};
+
+        // Owner only - returns false if full
+        bool push(IJob* job)
+        {
+            const auto b = bottom.load(std::memory_order_relaxed);
+            const auto t = top.load(std::memory_order_acquire);
+            if (b - t >= CAPACITY) [[unlikely]]
+                return false;
+            buffer[b & MASK].store(job, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Owner only - takes the newest job
+        IJob* pop()
+        {
+            const auto b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto t = top.load(std::memory_order_relaxed);
+            if (t > b) // Empty
+            {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            auto* job = buffer[b & MASK].load(std::memory_order_relaxed);
+            if (t == b) // Last element - race against thieves
+            {
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    job = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+
+        // Any thread - takes the oldest job
+        IJob* steal()
+        {
+            auto t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto b = bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return nullptr;
+            auto* job = buffer[t & MASK].load(std::memory_order_relaxed);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr; // Lost the race
+            return job;
+        }
+    };
+
+    struct DelayedJob final
+    {
+        float execTime;
+        IJob* job;
+        bool operator>(const DelayedJob& other) const { return execTime > other.execTime; }
+    };
+
+    // Pooled memory for coroutine frames - power of two size classes, bigger frames use the heap
+    struct FramePool final
+    {
+        static constexpr size_t MIN_SIZE = 256;
+        static constexpr int CLASS_COUNT = 5; // Up to 4096 bytes
+        static constexpr int MAX_CACHED = 64; // Per size class
+
+        std::vector<void*> freeFrames[CLASS_COUNT];
+        SpinLock lock;
+
+        ~FramePool()
+        {
+            for (auto& frames : freeFrames)
+            {
+                for (void* frame : frames)
+                    ::operator delete(frame);
+                frames.clear();
+            }
+        }
+
+        void* allocate(const size_t bytes)
+        {
+            const int sizeClass = GetClass(bytes);
+            if (sizeClass == -1) [[unlikely]]
+                return ::operator new(bytes);
+            {
+                SpinLockGuard guard{lock};
+                auto& frames = freeFrames[sizeClass];
+                if (!frames.empty()) [[likely]]
+                {
+                    void* frame = frames.back();
+                    frames.pop_back();
+                    return frame;
+                }
+            }
+            return ::operator new(MIN_SIZE << sizeClass);
+        }
+
+        void free(void* frame, const size_t bytes)
+        {
+            const int sizeClass = GetClass(bytes);
+            if (sizeClass != -1) [[likely]]
+            {
+                SpinLockGuard guard{lock};
+                auto& frames = freeFrames[sizeClass];
+                if (frames.size() < MAX_CACHED)
+                {
+                    frames.push_back(frame);
+                    return;
+                }
+            }
+            ::operator delete(frame);
+        }
+
+    private:
+        static int GetClass(const size_t bytes)
+        {
+            int sizeClass = 0;
+            while ((MIN_SIZE << sizeClass) < bytes)
+            {
+                if (++sizeClass == CLASS_COUNT)
+                    return -1;
+            }
+            return sizeClass;
+        }
+    };
+
+    struct alignas(64) JobWorker final
+    {
+        WorkStealingDeque deque;
+        std::deque<IJob*> inbox;    // Jobs from other threads
+        SpinLock inboxLock;         // The lock to make inbox access thread safe
+        std::atomic<int> inboxSize; // Allows to skip empty inboxes without locking
+        std::atomic<int64_t> spinNanos = 0; // Time spent spinning for new jobs
+        std::atomic<int64_t> idleNanos = 0; // Time spent parked
+        std::atomic<int> parks = 0;         // How often the worker parked
+
+        void addInbox(IJob* job)
+        {
+            SpinLockGuard guard{inboxLock};
+            inbox.push_back(job);
+            inboxSize.store(static_cast<int>(inbox.size()), std::memory_order_release);
+        }
+
+        IJob* takeInbox()
+        {
+            if (inboxSize.load(std::memory_order_acquire) == 0)
+                return nullptr;
+            SpinLockGuard guard{inboxLock};
+            if (inbox.empty())
+                return nullptr;
+            auto* job = inbox.front();
+            inbox.pop_front();
+            inboxSize.store(static_cast<int>(inbox.size()), std::memory_order_release);
+            return job;
+        }
+
+        [[nodiscard]] bool hasJobs() const
+        {
+            const auto& d = deque;
+            if (d.bottom.load(std::memory_order_relaxed) > d.top.load(std::memory_order_relaxed))
+                return true;
+            return inboxSize.load(std::memory_order_relaxed) > 0;
+        }
+    };
+
     struct JobData final
     {
-        alignas(64) std::deque<IJob*> queuedJobs;        // Global job queue
-        alignas(64) std::vector<const IJob*> workedJobs; // Currently processed jobs
-        std::vector<std::thread> threads;                // All working threads
-        cxstructs::SlotAllocator<50> jobAllocator;       // Allocator for jobs
-        SpinLock queueLock;                              // The lock to make queue access thread safe
-        SpinLock workedLock;                             // The lock to worked vector thread safe
-        std::atomic<bool> shutDown = false;              // Signal to shut down all threads
-        std::atomic<bool> isHibernate = false;           // If the scheduler is running
-        std::atomic<int> currentJobsSize = 0;            // Current jobs
-        uint16_t handleID = 0;                           // The internal handle counter
-        double targetTime = 0;
-        double sleepTime = 0;
+        static constexpr auto SPIN_TIME = std::chrono::microseconds(50); // Spinning before parking
+        static constexpr int MAX_THREADS = 256;
+
+        int requestedThreads = MAGIQUE_WORKER_THREADS;    // Worker threads to start on init - -1 is hardware based
+        bool pinThreads = false;                          // If threads are bound to a core
+        int threadCount = 0;                              // Amount of worker threads
+        int workerCount = 0;                              // Amount of worker queues - 1 if there are no threads
+        std::unique_ptr<JobWorker[]> workers;             // Per worker queues - a single inbox if there are no threads
+        std::vector<std::thread> threads;                 // All working threads
+        JobSlab slab;                                     // Job memory and handles - caches per worker + 1 for others
+        SpinLock externalLock;                            // The cache for other threads needs to be thread safe
+        std::atomic<bool> shutDown = false;               // Signal to shut down all threads
+        std::atomic<bool> isHibernate = false;            // If the scheduler is running
+        std::atomic<int> currentJobsSize = 0;             // Queued and running jobs
+        HashMap<JobID, std::vector<IJob*>> continuations; // Jobs waiting for the job with the handle
+        SpinLock continuationLock;                        // The lock to make continuation access thread safe
+        std::atomic<int> continuationCount = 0;           // Registered continuations - skips the lookup if 0
+        PriorityQueue<DelayedJob> delayedJobs{16};        // Jobs that are not due yet - earliest first
+        SpinLock delayLock;                               // The lock to make delayed access thread safe
+        std::atomic<float> nextDelayTime = FLT_MAX;       // Time the earliest delayed job is due
+        alignas(64) std::atomic<uint32_t> wakeEpoch = 0;  // Parked workers wait on this to change
+        std::atomic<int> parkedWorkers = 0;               // Skips the wake up if no worker is parked
+        std::atomic<uint32_t> nextWorker = 0;             // Round-robin index for submissions from other threads
+        std::thread::id mainThread;                       // Thread that runs the game loop - set on init
+        std::vector<std::coroutine_handle<>> mainResumes; // Tasks to resume on the main thread next frame
+        std::vector<std::coroutine_handle<>> tickResumes; // Tasks to resume on the main thread next update tick
+        std::vector<std::coroutine_handle<>> resuming;    // Swapped with the lists so resumed tasks can queue again
+        SpinLock resumeLock;                              // The lock to make resume list access thread safe
+        FramePool framePool;                              // Memory for coroutine frames
+        std::deque<IJob*> mainJobs[CRITICAL + 1];         // Jobs for the main thread - one queue per priority
+        SpinLock mainLock;                                // The lock to make main thread job access thread safe
+        std::atomic<int> mainJobCount = 0;                // Skips the drain if there are none
+        double mainBudget = 0.002;                        // Seconds main thread jobs can take each frame
 
         ~JobData() { close(); } // Added for safety
 
-        void addWorkedJob(const IJob* job)
+        // Creates the worker queues and starts the threads
+        void init(const int count, const bool pin)
         {
-            SpinLockGuard guard{workedLock};
+            threadCount = std::clamp(count, 0, MAX_THREADS);
+            workerCount = std::max(threadCount, 1);
+            pinThreads = pin;
+            workers = std::make_unique<JobWorker[]>(workerCount);
+            slab.init(workerCount + 1);
+            mainThread = std::this_thread::get_id();
+            if (pinThreads)
+                OSUtilPinThread(0);
+            for (int i = 0; i < threadCount; ++i)
+            {
+                threads.emplace_back(WorkerThreadFunc, this, i);
+            }
+        }
+
+        // Assigns the handle of the job and marks it as pending
+        void track(IJob* job)
+        {
+            job->id = slab.assign(job);
             ++currentJobsSize;
-            workedJobs.push_back(job);
         }
 
-        void removeWorkedJob(const IJob* job)
+        // Makes the job available to the workers
+        void submit(IJob* job)
+        {
+            const int index = WORKER_INDEX;
+            if (index >= 0 && workers[index].deque.push(job)) [[likely]]
+            {
+                wakeOne(); // Others can steal it
+                return;
+            }
+            // Any thread can submit from outside (main, asset loaders, networking, user threads)
+            const int target = index >= 0 ? index
+                                          : static_cast<int>(nextWorker.fetch_add(1, std::memory_order_relaxed) %
+                                                             static_cast<uint32_t>(workerCount));
+            workers[target].addInbox(job);
+            wakeOne();
+        }
+
+        // Removes one dependency of the job - submits it if it was the last
+        void release(IJob* job)
+        {
+            if (job->waitCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                submit(job);
+        }
+
+        // Returns true if the job now waits for the dependency - false if the dependency is already done
+        bool addContinuation(const JobID dependency, IJob* job)
+        {
+            // Counted before checking - a finishing dependency either sees the count or is seen as done
+            continuationCount.fetch_add(1, std::memory_order_seq_cst);
+            SpinLockGuard guard{continuationLock};
+            if (!slab.isPending(dependency, std::memory_order_seq_cst))
+            {
+                continuationCount.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+            job->waitCount.fetch_add(1, std::memory_order_relaxed);
+            continuations[dependency].push_back(job);
+            return true;
+        }
+
+        void releaseContinuations(const JobID id)
+        {
+            std::vector<IJob*> waiting;
+            {
+                SpinLockGuard guard{continuationLock};
+                const auto it = continuations.find(id);
+                if (it == continuations.end())
+                    return;
+                waiting = std::move(it->second);
+                continuations.erase(it);
+                continuationCount.fetch_sub(static_cast<int>(waiting.size()), std::memory_order_relaxed);
+            }
+            for (auto* job : waiting)
+            {
+                release(job);
+            }
+        }
+
+        // Returns the next job for the given worker - own deque, own inbox, then steals from the others
+        // The main thread (index -1) only steals - used when it helps while awaiting
+        IJob* findJob(const int index)
+        {
+            if (index >= 0)
+            {
+                auto& own = workers[index];
+                if (auto* job = own.deque.pop())
+                    return job;
+                if (auto* job = own.takeInbox())
+                    return job;
+            }
+            const int first = std::max(index, 0);
+            for (int i = index >= 0 ? 1 : 0; i < workerCount; ++i)
+            {
+                auto& other = workers[(first + i) % workerCount];
+                if (auto* job = other.deque.steal())
+                    return job;
+                if (auto* job = other.takeInbox())
+                    return job;
+            }
+            return nullptr;
+        }
+
+        // Holds the job back until its execution time
+        void schedule(IJob* job)
+        {
+            SpinLockGuard guard{delayLock};
+            delayedJobs.push({job->execTime, job});
+            nextDelayTime.store(delayedJobs.top().execTime, std::memory_order_release);
+        }
+
+        // Submits all delayed jobs that are due
+        void releaseDue()
+        {
+            const float time = EngineGetTime();
+            if (time < nextDelayTime.load(std::memory_order_acquire)) [[likely]]
+                return;
+            SpinLockGuard guard{delayLock};
+            while (!delayedJobs.empty() && delayedJobs.top().execTime <= time)
+            {
+                submit(delayedJobs.top().job);
+                delayedJobs.pop();
+            }
+            const float next = delayedJobs.empty() ? FLT_MAX : delayedJobs.top().execTime;
+            nextDelayTime.store(next, std::memory_order_release);
+        }
+
+        // Executes a queued job on the calling thread instead of idling - returns false if there was none
+        // Only the workers and the main thread help - other threads would share the thread index of the main thread
+        // The main thread only takes critical or the awaited main thread jobs - the others stay in the budgeted drain
+        // Awaiting null (all jobs) takes any main thread job - they are part of all jobs
+        bool help(const JobID awaited = JobID::null)
+        {
+            releaseDue();
+            const bool isMain = std::this_thread::get_id() == mainThread;
+            if (WORKER_INDEX < 0 && !isMain) [[unlikely]]
+                return false;
+            auto* job = findJob(WORKER_INDEX);
+            if (job == nullptr && isMain)
+                job = awaited == JobID::null ? takeMain(LOW) : takeMain(CRITICAL, awaited);
+            if (job == nullptr)
+                return false;
+            execute(job);
+            return true;
+        }
+
+        void addMain(IJob* job, const PriorityLevel priority)
         {
-            SpinLockGuard guard{workedLock};
+            SpinLockGuard guard{mainLock};
+            mainJobs[std::clamp(static_cast<int>(priority), static_cast<int>(LOW), static_cast<int>(CRITICAL))]
+                .push_back(job);
+            mainJobCount.fetch_add(1, std::memory_order_release);
+        }
+
+        // Returns the main thread job with the highest priority that is at least the given one
+        // Lower priority jobs are only returned if they have the given id
+        IJob* takeMain(const PriorityLevel minPriority, const JobID id = JobID::null)
+        {
+            if (mainJobCount.load(std::memory_order_acquire) == 0) [[likely]]
+                return nullptr;
+            SpinLockGuard guard{mainLock};
+            for (int i = CRITICAL; i >= LOW; --i)
+            {
+                auto& queue = mainJobs[i];
+                auto it = queue.begin();
+                if (i < minPriority)
+                    it = std::ranges::find_if(queue, [id](const IJob* job) { return job->id == id; });
+                if (it != queue.end())
+                {
+                    auto* job = *it;
+                    queue.erase(it);
+                    mainJobCount.fetch_sub(1, std::memory_order_relaxed);
+                    return job;
+                }
+            }
+            return nullptr;
+        }
+
+        // Main thread only - executes main thread jobs until the budget is used up (always critical ones)
+        void runMainJobs()
+        {
+            const double start = GetTime();
+            int executed = 0;
+            for (int i = mainJobCount.load(std::memory_order_acquire); i > 0; --i) // Only the jobs up to now
+            {
+                const bool overBudget = executed > 0 && GetTime() - start >= mainBudget;
+                auto* job = takeMain(overBudget ? CRITICAL : LOW);
+                if (job == nullptr)
+                    return;
+                execute(job);
+                ++executed;
+            }
+        }
+
+        void execute(IJob* job)
+        {
+            const auto id = job->id;
+            job->run();
+            job->~IJob();
+            slab.finish(id);
+            if (continuationCount.load(std::memory_order_seq_cst) > 0) [[unlikely]]
+                releaseContinuations(id);
             --currentJobsSize;
-            std::erase(workedJobs, job);
-            jobAllocator.free(job);
+            deallocate(job); // After the handle is done - the slot can be reused afterwards
+        }
+
+        void* allocate(const size_t bytes)
+        {
+            if (WORKER_INDEX >= 0) [[likely]]
+                return slab.allocate(WORKER_INDEX, bytes);
+            SpinLockGuard guard{externalLock};
+            return slab.allocate(workerCount, bytes);
+        }
+
+        void deallocate(void* job)
+        {
+            if (WORKER_INDEX >= 0) [[likely]]
+                return slab.free(WORKER_INDEX, job);
+            SpinLockGuard guard{externalLock};
+            slab.free(workerCount, job);
+        }
+
+        [[nodiscard]] bool isPending(const JobID id) const { return slab.isPending(id); }
+
+        [[nodiscard]] bool hasJobs() const
+        {
+            return std::ranges::any_of(getWorkers(), [](const JobWorker& worker) { return worker.hasJobs(); });
+        }
+
+        void wakeOne()
+        {
+            // Pairs with the fence in park() - either the job is seen or the parked worker
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (parkedWorkers.load(std::memory_order_relaxed) > 0)
+            {
+                wakeEpoch.fetch_add(1, std::memory_order_release);
+                wakeEpoch.notify_one();
+            }
+        }
+
+        void wakeAll()
+        {
+            wakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+            wakeEpoch.notify_all();
+        }
+
+        // Spins a short time for new jobs - returns true if jobs are available
+        bool spin(const int index)
+        {
+            using Clock = std::chrono::steady_clock;
+            const auto start = Clock::now();
+            auto now = start;
+            bool found = false;
+            while (now - start < SPIN_TIME)
+            {
+                if (hasJobs() || isHibernate.load(std::memory_order_relaxed))
+                {
+                    found = true;
+                    break;
+                }
+                std::this_thread::yield();
+                now = Clock::now();
+            }
+            const auto spinTime = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+            workers[index].spinNanos.fetch_add(spinTime, std::memory_order_relaxed);
+            return found;
+        }
+
+        // Blocks until woken up - returns immediately if there is something to do
+        void park(const int index)
+        {
+            const auto epoch = wakeEpoch.load(std::memory_order_acquire);
+            parkedWorkers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const bool hibernate = isHibernate.load(std::memory_order_relaxed);
+            if (!shutDown.load(std::memory_order_relaxed) && (hibernate || !hasJobs()))
+            {
+                using Clock = std::chrono::steady_clock;
+                const auto start = Clock::now();
+                wakeEpoch.wait(epoch, std::memory_order_acquire);
+                const auto idleTime = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+                auto& worker = workers[index];
+                worker.idleNanos.fetch_add(idleTime.count(), std::memory_order_relaxed);
+                worker.parks.fetch_add(1, std::memory_order_relaxed);
+            }
+            parkedWorkers.fetch_sub(1, std::memory_order_relaxed);
         }
 
         void onEachTick()
         {
-#if MAGIQUE_WORKER_THREADS == 0
-            for (auto it = queuedJobs.begin(); it != queuedJobs.end();)
+            releaseDue(); // Parked workers don't check - woken up by the submit
+            resumeAll(mainResumes);
+            if (threadCount == 0)
             {
-                if ((*it)->execTime <= EngineGetTime())
+                auto& worker = workers[0];
+                for (int i = worker.inboxSize.load(std::memory_order_acquire); i > 0; --i) // Only the jobs up to now
                 {
-                    (*it)->run();
-                    it = queuedJobs.erase(it);
+                    if (auto* job = worker.takeInbox())
+                        execute(job);
                 }
-                else
-                    ++it;
             }
-#endif
+        }
+
+        [[nodiscard]] std::span<JobWorker> getWorkers() const
+        {
+            return {workers.get(), static_cast<size_t>(workerCount)};
+        }
+
+        void queueResume(std::vector<std::coroutine_handle<>>& list, const std::coroutine_handle<> handle)
+        {
+            SpinLockGuard guard{resumeLock};
+            list.push_back(handle);
+        }
+
+        // Main thread only - resumes the tasks queued until now
+        void resumeAll(std::vector<std::coroutine_handle<>>& list)
+        {
+            {
+                SpinLockGuard guard{resumeLock};
+                if (list.empty()) [[likely]]
+                    return;
+                std::swap(list, resuming);
+            }
+            for (const auto handle : resuming)
+            {
+                handle.resume();
+            }
+            resuming.clear();
         }
 
         void close()
         {
             shutDown = true;
             isHibernate = true;
+            wakeAll();
             for (auto& t : threads)
             {
                 if (t.joinable())
@@ -72,39 +601,28 @@ namespace magique
                 }
             }
             threads.clear();
-            jobAllocator.destroy();
         }
 
-        static void WorkerThreadFunc(JobData* scheduler)
+        static void WorkerThreadFunc(JobData* scheduler, const int index)
         {
-            bool waited = false;
+            WORKER_INDEX = index;
+            if (scheduler->pinThreads)
+                OSUtilPinThread(index + 1); // Main thread has the first core
             while (!scheduler->shutDown.load(std::memory_order::acquire))
             {
-                while (!scheduler->isHibernate.load(std::memory_order::acquire))
+                if (!scheduler->isHibernate.load(std::memory_order::acquire)) [[likely]]
                 {
-                    waited = false;
-                    SpinLockGuard guard{scheduler->queueLock};
-                    if (!scheduler->queuedJobs.empty())
+                    scheduler->releaseDue();
+                    if (auto* job = scheduler->findJob(index))
                     {
-                        auto* job = scheduler->queuedJobs.front();
-                        if (job->execTime > EngineGetTime()) [[unlikely]]
-                            continue;
-                        scheduler->queuedJobs.pop_front();
-                        MAGIQUE_ASSERT(job->id != JobID::null, "Null handle");
-                        job->run();
-                        scheduler->removeWorkedJob(job);
+                        scheduler->execute(job);
+                        continue;
                     }
-                    std::this_thread::yield();
+                    // Jobs often come in bursts - spin shortly before parking
+                    if (scheduler->spin(index))
+                        continue;
                 }
-
-                // Wait more precisely with spinning at the end - only if necessary
-                if (!waited)
-                {
-                    if (GetTime() + scheduler->sleepTime < scheduler->targetTime)
-                        WaitTime(scheduler->targetTime, scheduler->sleepTime);
-                    waited = true;
-                }
-                std::this_thread::yield();
+                scheduler->park(index);
             }
         }
     };
@@ -2,6 +2,7 @@
 #ifndef MAGIQUE_PATHFINDING_DATA_H
 #define MAGIQUE_PATHFINDING_DATA_H
 
+#include <deque>
 #include <magique/core/Types.h>
 
 #include "internal/globals/StaticCollisionData.h"
@@ -12,8 +13,13 @@
 // Pathfinding Data
 //-----------------------------------------------
 // .....................................................................
-// Uses a stateless A* implementation with custom hashset and priority queue and octile distance heuristic
+// Uses a stateless A* implementation with custom hashset and radix heap and octile distance heuristic
 // Also weights the heuristics in favor of closing in on the target
+// GridMode::ANY searches like STAR and then removes all points that can be skipped in a straight line (string pulling)
+// Agents bigger than a cell are handled with a clearance map (distance to the closest solid cell) - O(1) per expansion
+//      - static : rebuilt together with the static grid
+//      - dynamic: updated lazily on the first search with a big agent each tick - only around changed cells
+// Results can be cached (LRU) - entries are validated against version counters of the regions they cover
 // For collision lookups hashmaps are used with bitset to pack bit data
 // There are two classes of solid objects: static and dynamic
 //      - static : Static objects (TileObjects, TilSet, ...) see core/StaticCollision.h
@@ -32,13 +38,31 @@ namespace magique
         // Grid data for each map - if cell is usable for pathfinding or not
         MapHolder<PathFindingGrid> mapsStaticGrids;
         MapHolder<PathFindingGrid> mapsDynamicGrids;
+        MapHolder<ClearanceGrid> mapsStaticClearance;
+        MapHolder<ClearanceGrid> mapsDynamicClearance;
+        MapHolder<PathRegionVersions> mapsRegionVersions;
+        uint32_t dynamicEpoch = 0; // Incremented each time the dynamic grids are rebuilt
+
+        // Cached search results - only used if a capacity is set
+        PathCache cache;
 
         // A star cache
         std::vector<Point> pathCache;
         StaticDenseLookupGrid<bool, 200> visited{};
         StaticDenseLookupGrid<float, 200> openCost{};
-        PriorityQueue<GridNode> frontier{500};
+        RadixHeap<GridNode> frontier{500}; // f-costs are nearly monotone - keys are quantized (see GetQueueKey())
         GridNode nodePool[MAGIQUE_MAX_PATH_SEARCH_CAPACITY];
+        int lastExpansions = 0; // Cells evaluated by the last search
+
+        // Queued requests
+        std::vector<PathRequest> requests;
+        std::vector<uint16_t> freeRequests;
+        std::deque<PathRequestID> pendingRequests; // Ids so cancelled entries of reused slots are skipped
+        int requestBudget = 4 * MAGIQUE_MAX_PATH_SEARCH_CAPACITY; // Cells evaluated per tick
+
+        // Visibility cache - tasks are the entries computed by the current batch
+        HashMap<Entity, PathVisibility> visibilityCache;
+        std::vector<PathVisibility*> visibilityTasks;
 
         // Lookup table for entity types and entities
         HashSet<Entity> solidEntities;
@@ -53,6 +77,27 @@ namespace magique
             return staticGrid.getIsMarked(x, y) || dynamicGrid.getIsMarked(x, y);
         }
 
+        // Quantizes the f-cost for the open list - 1/64 of a cell is precise enough to keep the cost order
+        static uint32_t GetQueueKey(const float fCost) { return static_cast<uint32_t>(std::max(fCost, 0.0F) * 64.0F); }
+
+        // Returns the clearance of the given cell - the distance in cells to the closest static or dynamic solid cell
+        uint8_t getClearance(const int cellX, const int cellY, const MapID map)
+        {
+            auto& dynamicClearance = mapsDynamicClearance[map];
+            dynamicClearance.sync(mapsDynamicGrids[map], dynamicEpoch);
+            const auto staticValue = mapsStaticClearance[map].getClearance(cellX, cellY);
+            return std::min(staticValue, dynamicClearance.getClearance(cellX, cellY));
+        }
+
+        // Returns the clearance an agent with the given bounds needs to fit into a cell
+        static uint8_t GetRequiredClearance(const Rect& bounds)
+        {
+            const float size = std::max(bounds.width, bounds.height);
+            // Cells the agent overlaps on each side when standing in the middle of a cell
+            const auto sideCells = static_cast<int>(std::ceil((size - cellSize) / (2.0F * cellSize)));
+            return static_cast<uint8_t>(std::clamp(sideCells + 1, 1, static_cast<int>(ClearanceGrid::MAX_CLEARANCE)));
+        }
+
         [[nodiscard]] bool getIsPathSolid(const Entity e, const EntityType type) const
         {
             return solidTypes.contains(type) || solidEntities.contains(e);
@@ -113,6 +158,239 @@ namespace magique
                     rasterizeRect(x, y, w, h);
                 }
             }
+
+            auto& clearance = mapsStaticClearance[map];
+            clearance.clear();
+            clearance.build(staticGrid);
+            mapsRegionVersions[map].staticVersion++;
+        }
+
+        // Returns true if the agent fits into all cells the line between the two cells passes
+        // Passing exactly through a corner checks both neighbouring cells
+        bool hasLineOfSight(int x0, int y0, const int x1, const int y1, const MapID map, const uint8_t clearance)
+        {
+            const auto& staticGrid = mapsStaticGrids[map];
+            const auto& dynamicGrid = mapsDynamicGrids[map];
+            const auto isFree = [&](const int x, const int y)
+            {
+                if (IsCellSolid(static_cast<float>(x * cellSize), static_cast<float>(y * cellSize), staticGrid,
+                                dynamicGrid))
+                    return false;
+                return clearance <= 1 || getClearance(x, y, map) >= clearance;
+            };
+
+            int dx = std::abs(x1 - x0);
+            int dy = std::abs(y1 - y0);
+            const int sx = x0 < x1 ? 1 : -1;
+            const int sy = y0 < y1 ? 1 : -1;
+            int error = dx - dy;
+            dx *= 2;
+            dy *= 2;
+            for (int n = 1 + (dx + dy) / 2; n > 0; --n)
+            {
+                if (!isFree(x0, y0))
+                    return false;
+                if (x0 == x1 && y0 == y1) // Reached - the corner check would test cells past the target
+                    break;
+                if (error > 0)
+                {
+                    x0 += sx;
+                    error -= dy;
+                }
+                else if (error < 0)
+                {
+                    y0 += sy;
+                    error += dx;
+                }
+                else // Corner
+                {
+                    if (!isFree(x0 + sx, y0) || !isFree(x0, y0 + sy))
+                        return false;
+                    x0 += sx;
+                    y0 += sy;
+                    error += dx - dy;
+                    --n;
+                }
+            }
+            return true;
+        }
+
+        // Removes all points that can be skipped by walking in a straight line - only the corners remain
+        void smoothPath(std::vector<Point>& path, const Point start, const MapID map, const uint8_t clearance)
+        {
+            if (path.size() < 2)
+                return;
+            const auto toCell = [](const Point& p)
+            { return std::pair{floordiv<cellSize>(p.x), floordiv<cellSize>(p.y)}; };
+
+            // Path is in reverse - iterate from the back and write the kept points into the front
+            auto [anchorX, anchorY] = toCell(start);
+            int write = static_cast<int>(path.size()) - 1;
+            int i = write;
+            while (i >= 0)
+            {
+                // Extend as far as visible from the last kept point
+                int last = i;
+                while (last > 0)
+                {
+                    const auto [x, y] = toCell(path[last - 1]);
+                    if (!hasLineOfSight(anchorX, anchorY, x, y, map, clearance))
+                        break;
+                    --last;
+                }
+                path[write--] = path[last];
+                std::tie(anchorX, anchorY) = toCell(path[last]);
+                i = last - 1;
+            }
+            path.erase(path.begin(), path.begin() + write + 1);
+        }
+
+        // Same as findPath() but returns cached results if the covered regions didn't change since
+        bool findPathCached(std::vector<Point>& path, const Point start, const Point end, const MapID map,
+                            const uint16_t maxPathLen, const GridMode mode, const uint8_t clearance = 1)
+        {
+            if (cache.capacity == 0)
+                return findPath(path, start, end, map, maxPathLen, mode, clearance);
+
+            const int startX = floordiv<cellSize>(start.x);
+            const int startY = floordiv<cellSize>(start.y);
+            const int endX = floordiv<cellSize>(end.x);
+            const int endY = floordiv<cellSize>(end.y);
+            const PathCacheKey key{
+                GetVisitedCellID(startX, startY), GetVisitedCellID(endX, endY), maxPathLen, map, mode, clearance};
+
+            auto& versions = mapsRegionVersions[map];
+            versions.sync(mapsDynamicGrids[map], dynamicEpoch);
+
+            if (const auto* entry = cache.get(key))
+            {
+                const auto regionVersion = versions.getVersionSum(entry->minX, entry->minY, entry->maxX, entry->maxY);
+                if (entry->staticVersion == versions.staticVersion && entry->regionVersion == regionVersion)
+                {
+                    lastExpansions = 0;
+                    path.assign(entry->path.begin(), entry->path.end());
+                    return entry->reached;
+                }
+                cache.erase(key);
+            }
+
+            const bool reached = findPath(path, start, end, map, maxPathLen, mode, clearance);
+
+            // The covered area is the bounding box of the path and both ends - padded by a region
+            int minX = std::min(startX, endX);
+            int maxX = std::max(startX, endX);
+            int minY = std::min(startY, endY);
+            int maxY = std::max(startY, endY);
+            for (const auto& point : path)
+            {
+                const int x = floordiv<cellSize>(point.x);
+                const int y = floordiv<cellSize>(point.y);
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
+
+            auto& entry = cache.add(key);
+            entry.path.assign(path.begin(), path.end());
+            entry.minX = static_cast<int16_t>(PathRegionVersions::GetRegion(minX) - 1);
+            entry.minY = static_cast<int16_t>(PathRegionVersions::GetRegion(minY) - 1);
+            entry.maxX = static_cast<int16_t>(PathRegionVersions::GetRegion(maxX) + 1);
+            entry.maxY = static_cast<int16_t>(PathRegionVersions::GetRegion(maxY) + 1);
+            entry.regionVersion = versions.getVersionSum(entry.minX, entry.minY, entry.maxX, entry.maxY);
+            entry.staticVersion = versions.staticVersion;
+            entry.reached = reached;
+            return reached;
+        }
+
+        PathRequestID addRequest(PathRequest&& request)
+        {
+            uint16_t index;
+            if (freeRequests.empty())
+            {
+                MAGIQUE_ASSERT(requests.size() < UINT16_MAX, "Too many pending path requests");
+                index = static_cast<uint16_t>(requests.size());
+                requests.emplace_back();
+            }
+            else
+            {
+                index = freeRequests.back();
+                freeRequests.pop_back();
+            }
+            auto& slot = requests[index];
+            request.generation = slot.generation;
+            request.status = PathStatus::PENDING;
+            slot = std::move(request);
+            const auto id = slot.getID(index);
+            pendingRequests.push_back(id);
+            return id;
+        }
+
+        // Returns the request with the given id or nullptr if it's invalid
+        PathRequest* getRequest(const PathRequestID id)
+        {
+            const auto index = PathRequest::GetIndex(id);
+            if (id == PathRequestID::null || index >= requests.size())
+                return nullptr;
+            auto& request = requests[index];
+            if (request.status == PathStatus::INVALID || request.generation != PathRequest::GetGeneration(id))
+                return nullptr;
+            return &request;
+        }
+
+        void releaseRequest(const PathRequestID id)
+        {
+            const auto index = PathRequest::GetIndex(id);
+            auto& request = requests[index];
+            request.status = PathStatus::INVALID;
+            request.generation++;
+            request.path.clear(); // Keeps the capacity for the next request in this slot
+            freeRequests.push_back(index);
+        }
+
+        // Processes queued requests until the budget is used up - called once per tick
+        void processRequests()
+        {
+            int budget = requestBudget;
+            bool searched = false; // Guarantees progress even with a tiny budget
+            while (!pendingRequests.empty() && (budget > 0 || !searched))
+            {
+                auto* pending = getRequest(pendingRequests.front());
+                if (pending == nullptr || pending->status != PathStatus::PENDING) // Cancelled - slot can be reused
+                {
+                    pendingRequests.pop_front();
+                    continue;
+                }
+                auto& request = *pending;
+
+                if (request.samples > 0) // Random target - one position per search
+                {
+                    const auto random = request.area.random();
+                    request.samples--;
+                    if (findPath(request.path, request.start, random, request.map, request.maxLen, request.mode,
+                                 request.clearance))
+                    {
+                        request.target = random;
+                        request.status = PathStatus::REACHED;
+                    }
+                    else if (request.samples == 0)
+                    {
+                        request.path.clear();
+                        request.status = PathStatus::PARTIAL;
+                    }
+                }
+                else
+                {
+                    const bool reached = findPathCached(request.path, request.start, request.target, request.map,
+                                                        request.maxLen, request.mode, request.clearance);
+                    request.status = reached ? PathStatus::REACHED : PathStatus::PARTIAL;
+                }
+
+                if (request.status != PathStatus::PENDING)
+                    pendingRequests.pop_front();
+                budget -= std::max(lastExpansions, 1);
+                searched = true;
+            }
         }
 
         void initPathFinding(std::vector<Point>& path, const Point& start)
@@ -126,7 +404,7 @@ namespace magique
         }
 
         bool findPath(std::vector<Point>& path, Point start, Point end, const MapID map, const uint16_t maxPathLen,
-                      GridMode mode, PathFindHeuristicFunc hFunc = nullptr)
+                      GridMode mode, const uint8_t clearance = 1, PathFindHeuristicFunc hFunc = nullptr)
         {
             start = Point{start / cellSize}.floor();
             end = Point{end / cellSize}.floor();
@@ -139,8 +417,10 @@ namespace magique
             uint16_t bestNodeIndex = 0;
             float bestDistance = 1e12;
 
+            lastExpansions = 0;
+
             // Viability check
-            if (IsCellSolid(start.x, start.y, staticGrid, dynamicGrid)) [[unlikely]]
+            if (IsCellSolid(start.x * cellSize, start.y * cellSize, staticGrid, dynamicGrid)) [[unlikely]]
             {
                 return false;
             }
@@ -152,9 +432,11 @@ namespace magique
 
             const PathFindMoveCostFunc mFunc = MOVE_COST[(int)mode];
             const auto& movement = MOVEMENTS[(int)mode];
+            const bool checkClearance = clearance > 1;
 
             auto hCost = hFunc(start, end);
-            frontier.emplace(start, 0.0F, hCost, hCost, UINT16_MAX, 0); // Initial node - no move cost
+            // Initial node - no move cost
+            frontier.emplace(GetQueueKey(hCost), start, 0.0F, hCost, hCost, UINT16_MAX, 0);
             while (!frontier.empty() && iteration < MAGIQUE_MAX_PATH_SEARCH_CAPACITY)
             {
                 nodePool[iteration] = frontier.top();
@@ -171,7 +453,10 @@ namespace magique
 
                 if (current.position == end) [[unlikely]]
                 {
+                    lastExpansions = iteration + 1;
                     constructPath(current, path);
+                    if (mode == GridMode::ANY)
+                        smoothPath(path, start * cellSize, map, clearance);
                     return true;
                 }
 
@@ -192,6 +477,13 @@ namespace magique
                             continue;
                         }
 
+                        // Enough space for the agent
+                        if (checkClearance && getClearance(static_cast<int>(newPosTile.x),
+                                                           static_cast<int>(newPosTile.y), map) < clearance)
+                        {
+                            continue;
+                        }
+
                         const auto bestValueForTile = openCost.getValue(newPosTile);
                         const float gCost = mFunc(dir) + current.gCost;
                         const auto hCost = hFunc(newPosTile, end);
@@ -202,13 +494,17 @@ namespace magique
                         {
                             continue;
                         }
-                        frontier.push({newPosTile, gCost, newFCost, hCost, iteration, newPathLen});
+                        const GridNode node{newPosTile, gCost, newFCost, hCost, iteration, newPathLen};
+                        frontier.push(GetQueueKey(newFCost), node);
                         openCost.setValue(newPosTile, newFCost);
                     }
                     iteration++;
                 }
             }
+            lastExpansions = iteration;
             constructPath(nodePool[bestNodeIndex], path);
+            if (mode == GridMode::ANY)
+                smoothPath(path, start * cellSize, map, clearance);
             return false;
         }
 
@@ -2,14 +2,62 @@
 #ifndef MAGIQUE_SCRIPTENGINE_H
 #define MAGIQUE_SCRIPTENGINE_H
 
+#include <magique/ecs/ECS.h>
 #include <magique/ecs/Scripting.h>
 
 namespace magique
 {
+    // Scripted entities of a single type - each script is called once per batch
+    struct ScriptBatch final
+    {
+        EntityScript* script = nullptr;
+        std::vector<Entity> entities;
+        bool isParallel = false; // If onUpdate is called in parallel
+    };
+
     struct ScriptData final
     {
         inline static auto* defaultScript = new EntityScript();
         HashMap<EntityType, EntityScript*> scripts;
+        std::vector<ScriptBatch> batches;   // Indexed by the entity type - cached to avoid allocations
+        std::vector<EntityType> batchTypes; // Types that have entities in the current batches
+        HashSet<EntityType> parallelTypes;  // Types whose script can be updated in parallel
+        std::vector<internal::CommandBuffer> chunkBuffers; // Structural changes of each parallel chunk
+
+        static constexpr int PARALLEL_CHUNK = 128; // Entities per chunk - fixed so the recording is deterministic
+
+        [[nodiscard]] EntityScript* getScript(const EntityType type) const
+        {
+            const auto it = scripts.find(type);
+            MAGIQUE_ASSERT(it != scripts.end(), "No script registered for this type! ");
+            if (it == scripts.end())
+            {
+                return defaultScript;
+            }
+            return it->second;
+        }
+
+        // Returns the empty batch for the type - the script is looked up once
+        ScriptBatch& startBatch(const EntityType type)
+        {
+            const auto index = static_cast<int>(type);
+            if (index >= static_cast<int>(batches.size())) [[unlikely]]
+                batches.resize(index + 1);
+            auto& batch = batches[index];
+            batch.script = getScript(type);
+            batch.isParallel = parallelTypes.contains(type);
+            batchTypes.push_back(type);
+            return batch;
+        }
+
+        void clearBatches()
+        {
+            for (const auto type : batchTypes)
+            {
+                batches[static_cast<int>(type)].entities.clear();
+            }
+            batchTypes.clear();
+        }
     };
 
     namespace global
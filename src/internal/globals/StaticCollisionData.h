@@ -38,8 +38,8 @@ namespace magique
     };
 
     using TileHashGrid = SingleResolutionHashGrid<StaticID, MAGIQUE_MAX_ENTITIES_CELL, 32>;
-    using StaticPairCollector = AlignedVec<StaticPair>[MAGIQUE_WORKER_THREADS + 1];
-    using ColliderCollector = AlignedVec<StaticID>[MAGIQUE_WORKER_THREADS + 1];
+    using StaticPairCollector = std::vector<AlignedVec<StaticPair>>; // One per thread - sized on init
+    using ColliderCollector = std::vector<AlignedVec<StaticID>>;
 
     struct ColliderStorage final
     {
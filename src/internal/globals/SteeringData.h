@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#ifndef MAGIQUE_STEERING_DATA_H
+#define MAGIQUE_STEERING_DATA_H
+
+#include <magique/core/Types.h>
+#include <magique/util/Datastructures.h>
+
+//-----------------------------------------------
+// Steering Data
+//-----------------------------------------------
+// .....................................................................
+// Agents are stored densely in the hashmap so they can be split into ranges for the job system
+// Each thread has its own scratch memory - the new velocities are only applied after all chunks are done
+// .....................................................................
+
+namespace magique
+{
+    struct SteerAgent final
+    {
+        Point position;    // Middle of the collision bounds - captured before computing
+        Point velocity;    // Adjusted velocity of the last computation
+        Point preferred;   // Velocity the agent wants to move with
+        Point newVelocity; // Result of the current computation
+        float maxSpeed = 0.0F;
+        float timeHorizon = 0.0F;
+        float radius = 0.0F;     // 0 means it's taken from the collision bounds
+        float usedRadius = 0.0F; // Radius of the current computation
+        MapID map{};
+        bool isValid = false; // If it has the required components this tick
+    };
+
+    // A half-plane of permitted velocities - left of the direction is valid
+    struct OrcaLine final
+    {
+        Point point;
+        Point direction;
+    };
+
+    struct alignas(64) SteerScratch final // Aligned to prevent false sharing
+    {
+        std::vector<Entity> query;
+        std::vector<std::pair<float, Entity>> neighbours;
+        std::vector<OrcaLine> lines;
+        std::vector<OrcaLine> projectedLines;
+    };
+
+    struct SteeringData final
+    {
+        static constexpr int MAX_NEIGHBOURS = 10; // Closest neighbours considered per agent
+
+        HashMap<Entity, SteerAgent> agents;
+        std::vector<SteerScratch> scratch; // One per thread - sized on init
+    };
+
+    namespace global
+    {
+        inline SteeringData STEER_DATA{};
+    }
+} // namespace magique
+
+#endif // MAGIQUE_STEERING_DATA_H
@@ -60,32 +60,22 @@
 namespace magique
 {
     void HandleCollisionPairs();
-    void CheckHashGridCells(float beginPercent, float endPercent, int thread);
+    void CheckHashGridCells(const EntityHashGrid& hashGrid, int thread, int start, int end);
 
     //----------------- SYSTEM -----------------//
 
     inline void DynamicCollisionSystem()
     {
-#if MAGIQUE_WORKER_THREADS > 0
-        const int size = global::ENGINE_DATA.collisionVec.size();
-        if (size > 500) // Multithreading over certain amount
-        {
-            std::array<JobID, COL_WORK_PARTS> handles{};
-            constexpr float mainThreadPart = 1.0F / COL_WORK_PARTS * 1.19; // 19% more work for main thread
-            constexpr float workerPart = (1.0F - mainThreadPart) / (COL_WORK_PARTS - 1);
-            float beginPercent = 0.0F;
-            for (int j = 0; j < COL_WORK_PARTS - 1; ++j)
-            {
-                handles[j] = JobAddEx(CheckHashGridCells, beginPercent, beginPercent + workerPart, j);
-                beginPercent += workerPart;
-            }
-            CheckHashGridCells(beginPercent, 1.0F, COL_WORK_PARTS - 1);
-            JobAwait(handles);
-        }
-        else
-#endif
+        const auto& data = global::ENGINE_DATA;
+        const auto& dynamic = global::DY_COLL_DATA;
+        const bool isParallel = data.collisionVec.size() > 500; // Multithreading over certain amount
+        for (const auto loadedMap : data.loadedMaps)
         {
-            CheckHashGridCells(0.0F, 1.0F, 0);
+            const auto& hashGrid = dynamic.mapEntityGrids[loadedMap];
+            const int size = static_cast<int>(hashGrid.cellMap.size());
+            const auto checkCells = [&](const int thread, const int start, const int end)
+            { CheckHashGridCells(hashGrid, thread, start, end); };
+            JobParallelFor(size, isParallel ? 16 : size, checkCells);
         }
         HandleCollisionPairs();
     }
@@ -149,50 +139,37 @@ namespace magique
         pairSet.clear();
     }
 
-    inline void CheckHashGridCells(const float beginP, const float endP, const int thread)
+    inline void CheckHashGridCells(const EntityHashGrid& hashGrid, const int thread, const int startIdx,
+                                   const int endIdx)
     {
-        const auto& data = global::ENGINE_DATA;
         auto& dynamic = global::DY_COLL_DATA;
         const auto& group = internal::POSITION_GROUP;
 
         auto& pairs = dynamic.collisionPairs[thread].vec;
-        for (const auto loadedMap : data.loadedMaps)
+        const auto start = hashGrid.dataBlocks.begin() + startIdx;
+        const auto end = hashGrid.dataBlocks.begin() + endIdx;
+        for (auto it = start; it != end; ++it)
         {
-            const auto& hashGrid = dynamic.mapEntityGrids[loadedMap];
-            const int size = static_cast<int>(hashGrid.cellMap.size());
-            if (size < COL_WORK_PARTS && thread != COL_WORK_PARTS - 1)
+            const auto& block = *it;
+            const auto* dStart = block.data;
+            const auto* dEnd = block.data + block.size;
+            for (const auto* dIt1 = dStart; dIt1 != dEnd; ++dIt1)
             {
-                // If cant be split into parts let main thread do it alone
-                continue;
-            }
-
-            const int startIdx = static_cast<int>(beginP * static_cast<float>(size));
-            const int endIdx = static_cast<int>(endP * static_cast<float>(size));
-            const auto start = hashGrid.dataBlocks.begin() + startIdx;
-            const auto end = hashGrid.dataBlocks.begin() + endIdx;
-            for (auto it = start; it != end; ++it)
-            {
-                const auto& block = *it;
-                const auto* dStart = block.data;
-                const auto* dEnd = block.data + block.size;
-                for (const auto* dIt1 = dStart; dIt1 != dEnd; ++dIt1)
+                const auto first = *dIt1;
+                auto [posA, colA] = group.get<const PositionC, CollisionC>(first);
+                for (const auto* dIt2 = dIt1 + 1; dIt2 != dEnd; ++dIt2)
                 {
-                    const auto first = *dIt1;
-                    auto [posA, colA] = group.get<const PositionC, CollisionC>(first);
-                    for (const auto* dIt2 = dIt1 + 1; dIt2 != dEnd; ++dIt2)
+                    const auto second = *dIt2;
+                    auto [posB, colB] = group.get<const PositionC, CollisionC>(second);
+                    if (!colA.detects(colB) && !colB.detects(colA))
+                    {
+                        continue; // Not checking for each other
+                    }
+                    CollisionInfo info{};
+                    internal::CheckCollisionEntities(posA, colA, posB, colB, info);
+                    if (info.isColliding())
                     {
-                        const auto second = *dIt2;
-                        auto [posB, colB] = group.get<const PositionC, CollisionC>(second);
-                        if (!colA.detects(colB) && !colB.detects(colA))
-                        {
-                            continue; // Not checking for each other
-                        }
-                        CollisionInfo info{};
-                        internal::CheckCollisionEntities(posA, colA, posB, colB, info);
-                        if (info.isColliding())
-                        {
-                            pairs.push_back(PairInfo{info, first, second});
-                        }
+                        pairs.push_back(PairInfo{info, first, second});
                     }
                 }
             }
@@ -44,7 +44,7 @@ namespace magique
 
         cVec.push_back(e);
         const auto bb = pos.getBounds(col);
-        grid.insert(e, bb.x, bb.y, bb.width, bb.height);
+        global::DY_COLL_DATA.insertEntity(e, bb, grid);
         if (isPathSolid) [[unlikely]]
         {
             pathGrid.insert(bb.x, bb.y, bb.width, bb.height);
@@ -94,9 +94,24 @@ namespace magique
         }
     }
 
+    // Re-bins a part of all entities each tick - catches dormant entities that were moved (e.g. by the user)
+    inline void SweepRegions(EntityRegionIndex& index, const bool sweepAll)
+    {
+        const auto& storage = internal::REGISTRY.storage<PositionC>();
+        const auto size = static_cast<uint32_t>(storage.size());
+        const auto count = sweepAll ? size : std::min(size, size / EntityRegionIndex::SWEEP_TICKS + 1);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (index.sweepCursor >= size)
+                index.sweepCursor = 0;
+            const auto e = storage.data()[index.sweepCursor++];
+            const auto& pos = storage.get(e);
+            index.update(e, pos.pos, pos.map);
+        }
+    }
+
     inline void IterateEntities()
     {
-        const auto& registry = internal::REGISTRY;
         auto& data = global::ENGINE_DATA;
         auto& config = global::ENGINE_CONFIG;
         const auto& group = internal::POSITION_GROUP;
@@ -105,9 +120,10 @@ namespace magique
         auto& drawVec = data.drawVec;
         auto& cache = data.entityUpdateCache;
         auto& collisionVec = data.collisionVec;
+        auto& regionIndex = data.regionIndex;
 
         // Cache
-        const uint16_t cacheDuration = config.entityCacheDuration;
+        const uint32_t activeUntil = data.engineTicks + config.entityCacheDuration; // Updated until then
         int actorCount = 0;
         const auto cameraMap = data.cameraMap;
         const Rect camBound = CameraGetBounds();
@@ -116,13 +132,11 @@ namespace magique
         ActorMapDistribution actorDist{};
         ActorRectsTable actorRects{};
         ActorMapsTable actorMaps{};
-        std::array<bool, UINT8_MAX> loadedMaps{};
 
         BuildCache(actorRects, actorMaps, actorDist, actorCount);
 
-        // Iterate all entities and insert them into the hashgrids and drawVec/collisionVec
-        const auto view = registry.view<const PositionC>();
-        for (const auto e : view)
+        // Insert the entities of the active regions into the hashgrids and drawVec/collisionVec
+        const auto visitEntity = [&](const Entity e)
         {
             const auto& posC = group.get<const PositionC>(e);
             const auto* colC = ComponentTryGet<CollisionC>(e);
@@ -133,18 +147,16 @@ namespace magique
                 pos += colC->getMidOffset();
 
             const auto map = posC.map;
-
-            loadedMaps[static_cast<int>(map)] = true;
             auto& hashGrid = dynamicData.mapEntityGrids[map];
 
-            if (!loadedMaps[static_cast<int>(map)]) [[unlikely]] // No actor is in the map of the entity
-                continue;
+            if (regionIndex.hasMoved(e, posC.pos, map)) [[unlikely]] // Can't move while visiting
+                regionIndex.movedEntities.push_back(e);
 
             // Check if inside the camera bounds already
             if (map == cameraMap && camBound.contains(pos))
             {
                 drawVec.push_back(e); // Should be drawn
-                cache[e] = cacheDuration;
+                cache.add(e, activeUntil);
                 if (hasCollision)
                     HandleCollisionEntity(e, posC, *colC, hashGrid, collisionVec);
             }
@@ -159,25 +171,90 @@ namespace magique
                     // Check if inside any update rect - rect is an enlarged rectangle
                     if (actorRects[actorNum].contains(pos))
                     {
-                        cache[e] = cacheDuration;
+                        cache.add(e, activeUntil);
                         if (group.contains(e))
                             HandleCollisionEntity(e, posC, *colC, hashGrid, collisionVec);
                         break;
                     }
                 }
             }
+        };
+
+        // Before visiting so they are visited in their new chunk this tick
+        const auto& positions = internal::REGISTRY.storage<PositionC>();
+        for (const auto e : regionIndex.touched)
+        {
+            if (!positions.contains(e)) // Destroyed since
+                continue;
+            const auto& posC = positions.get(e);
+            regionIndex.update(e, posC.pos, posC.map);
         }
+        regionIndex.touched.clear();
+        // Clients write the positions received from the host directly - all are checked so none are missed
+        SweepRegions(regionIndex, config.isClientMode);
 
-        // Generate a dense vector of the loaded maps - map is loaded if it contains at least 1 entity
+        std::array<Rect, MAGIQUE_MAX_PLAYERS + 1> activeRects{};
+        regionIndex.movedEntities.clear();
         for (int i = 0; i < UINT8_MAX; ++i)
         {
-            if (loadedMaps[i])
+            const auto map = static_cast<MapID>(i);
+            if (regionIndex.getCount(map) == 0) [[likely]]
+                continue;
+            data.loadedMaps.push_back(map); // Map is loaded if it contains at least 1 entity
+            dynamicData.mapEntityGrids[map]; // Each loaded map has a grid - even if no region is active
+
+            // Only the regions around the camera and actors are visited
+            int rectCount = 0;
+            if (map == cameraMap)
+                activeRects[rectCount++] = camBound;
+            for (int j = 0; j < actorCount; ++j)
             {
-                data.loadedMaps.push_back(static_cast<MapID>(i));
+                const int8_t actorNum = actorDist.getActorNum(map, j);
+                if (actorNum == -1) // No more actors in that map
+                    break;
+                activeRects[rectCount++] = actorRects[actorNum];
             }
+            regionIndex.forEach(map, {activeRects.data(), static_cast<size_t>(rectCount)}, visitEntity);
+        }
+
+        for (const auto e : regionIndex.movedEntities)
+        {
+            const auto& posC = group.get<const PositionC>(e);
+            regionIndex.update(e, posC.pos, posC.map);
+        }
+    }
+
+    // Calls the script on all threads in fixed chunks - each chunk records into its own buffer
+    // Buffers are executed in chunk order - the same no matter which thread updated which chunk
+    inline void UpdateScriptParallel(const ScriptBatch& batch)
+    {
+        constexpr int chunkSize = ScriptData::PARALLEL_CHUNK;
+        auto& buffers = global::SCRIPT_DATA.chunkBuffers;
+        const std::span<const Entity> entities = batch.entities;
+        const int size = static_cast<int>(entities.size());
+        const int chunks = (size + chunkSize - 1) / chunkSize;
+        if (static_cast<int>(buffers.size()) < chunks)
+            buffers.resize(chunks);
+        MAGIQUE_ASSERT(internal::COMMAND_BUFFER == nullptr, "Parallel scripts can't be nested");
+
+        JobParallelFor(chunks, 1,
+                       [&](int, const int start, const int end)
+                       {
+                           for (int i = start; i < end; ++i)
+                           {
+                               const int first = i * chunkSize;
+                               const internal::CommandBufferScope scope{&buffers[i]};
+                               batch.script->onUpdateBatch(entities.subspan(first, std::min(chunkSize, size - first)));
+                           }
+                       });
+
+        for (int i = 0; i < chunks; ++i)
+        {
+            buffers[i].execute();
         }
     }
 
+    // Groups all scripted entities by type and calls each script once per type
     template <bool isEnd>
     void CallUpdateEntityScript()
     {
@@ -185,24 +262,46 @@ namespace magique
         if (config.isClientMode) // Skip script methods in client mode
             return;
 
-        auto& data = global::ENGINE_DATA;
-        auto& cache = data.entityUpdateCache;
+        const auto& data = global::ENGINE_DATA;
+        const auto& typeIndex = global::ECS_DATA.typeIndex;
+        auto& scriptData = global::SCRIPT_DATA;
+        const bool checkScripted = !data.entityNScriptedSet.empty(); // Skip the lookup if all are scripted
 
-        // Iterates all entities
-        for (const auto entity : EntityGetRegistry().view<Entity>())
+        scriptData.clearBatches();
+        for (int i = 0; i < typeIndex.getTypeCount(); ++i)
         {
-            // Invoke tick event on all entities that are in this tick and are scripted
-            if (data.isEntityScripted(entity)) [[likely]]
+            const auto type = static_cast<EntityType>(i);
+            const auto entities = typeIndex.get(type);
+            if (entities.empty())
+                continue;
+            auto& batch = scriptData.startBatch(type);
+            if (checkScripted) [[unlikely]]
             {
-                // Pass a boolean whether the entity is updated => if it's in the cache
-                if constexpr (isEnd)
-                    internal::GetScriptInternal(entity)->onUpdate(entity, cache.contains(entity));
-                else
-                    internal::GetScriptInternal(entity)->onUpdateEnd(entity, cache.contains(entity));
+                for (const auto entity : entities)
+                {
+                    if (data.isEntityScripted(entity))
+                        batch.entities.push_back(entity);
+                }
+            }
+            else
+            {
+                batch.entities.assign(entities.begin(), entities.end()); // Copied - scripts can create and destroy
             }
         }
-    }
 
+        for (const auto type : scriptData.batchTypes)
+        {
+            const auto& batch = scriptData.batches[static_cast<int>(type)];
+            if (batch.entities.empty()) [[unlikely]]
+                continue;
+            if constexpr (isEnd)
+                batch.script->onUpdateEndBatch(batch.entities);
+            else if (batch.isParallel)
+                UpdateScriptParallel(batch);
+            else
+                batch.script->onUpdateBatch(batch.entities);
+        }
+    }
 
     inline void LogicSystem(const entt::registry& registry)
     {
@@ -223,26 +322,16 @@ namespace magique
         drawVec.clear();                    // Drawn entities
         updateVec.clear();                  // Update entities
         collisionVec.clear();               // Collision entities
+        data.invalidateSlots();             // Slots of the above vectors
         dynamicData.mapEntityGrids.clear(); // Collision entity hashgrid
         pathData.mapsDynamicGrids.clear();  // Pathfinding solid entities hashgrid
+        pathData.dynamicEpoch++;            // Clearance and cached paths compare against the new dynamic grid
 
         // Iterates all entities
         IterateEntities();
 
         // Fill the update vec after to avoid adding entities that drop out
-        for (auto it = cache.begin(); it != cache.end();)
-        {
-            if (it->second > 0)
-            {
-                it->second--;
-                updateVec.push_back(it->first);
-                ++it;
-            }
-            else
-            {
-                it = cache.erase(it);
-            }
-        }
+        cache.collect(data.engineTicks, updateVec);
 
         CallUpdateEntityScript<false>();
     }
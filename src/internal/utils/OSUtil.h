@@ -10,4 +10,7 @@ uint64_t GetMemoryWorkingSet();
 
 const char* OSUtilGetLocalIP();
 
+// Binds the calling thread to the given core (wraps around the core count) - returns false if not supported
+bool OSUtilPinThread(int core);
+
 #endif // MAGIQUE_OSUTIL_H
@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include <magique/util/JobSystem.h>
+#include <magique/util/JobTask.h>
 #include <magique/util/Logging.h>
 #include <magique/core/Engine.h>
 
@@ -11,55 +12,174 @@
 namespace magique
 {
 
-    static bool IsPresent(JobID id)
+    void JobAwait(const JobID id)
     {
         auto& scd = global::SCHEDULER;
+        while (scd.isPending(id))
         {
-            SpinLockGuard guard{scd.queueLock};
-            if (std::ranges::any_of(scd.queuedJobs, [&](const IJob* job) { return job->id == id; }))
-                return true;
+            if (!scd.help(id))
+                std::this_thread::yield();
         }
+    }
+
+    void JobAwait(std::span<const JobID> handles)
+    {
+        for (const auto id : handles)
         {
-            SpinLockGuard guard{scd.workedLock};
-            if (std::ranges::any_of(scd.workedJobs, [&](const IJob* job) { return job->id == id; }))
-                return true;
+            JobAwait(id);
         }
-        return false;
     }
 
-    void JobAwait(JobID id)
+    void JobAwaitAll()
     {
-        while (true)
+        auto& scd = global::SCHEDULER;
+        while (scd.currentJobsSize.load(std::memory_order_acquire) > 0)
         {
-            if (IsPresent(id)) [[likely]]
+            if (!scd.help())
                 std::this_thread::yield();
-            else
-                break;
         }
     }
 
-    void JobAwait(std::span<const JobID> handles)
+    void JobSetMainThreadBudget(const float millis)
+    {
+        global::SCHEDULER.mainBudget = static_cast<double>(std::max(millis, 0.0F)) / 1000.0;
+    }
+
+    int JobGetThreadCount() { return global::SCHEDULER.threadCount + 1; }
+
+    void JobSetWorkerCount(const int count, const bool pinThreads)
     {
-        while (std::ranges::any_of(handles, IsPresent))
+        auto& scd = global::SCHEDULER;
+        if (!scd.threads.empty() || scd.workerCount > 0) [[unlikely]]
         {
-            std::this_thread::yield();
+            LOG_WARNING("Worker count has to be set before the job system is initialized. Skipping...");
+            return;
         }
+        scd.requestedThreads = count;
+        scd.pinThreads = pinThreads;
     }
 
-    void JobAwaitAll()
+    JobStats JobGetStats()
     {
-        auto& scd = global::SCHEDULER;
+        JobStats stats{};
+        int64_t spinNanos = 0;
+        int64_t idleNanos = 0;
+        for (const auto& worker : global::SCHEDULER.getWorkers())
+        {
+            spinNanos += worker.spinNanos.load(std::memory_order_relaxed);
+            idleNanos += worker.idleNanos.load(std::memory_order_relaxed);
+            stats.parks += worker.parks.load(std::memory_order_relaxed);
+        }
+        stats.spinMillis = static_cast<float>(static_cast<double>(spinNanos) / 1e6);
+        stats.idleMillis = static_cast<float>(static_cast<double>(idleNanos) / 1e6);
+        return stats;
+    }
+
+    void JobResetStats()
+    {
+        for (auto& worker : global::SCHEDULER.getWorkers())
+        {
+            worker.spinNanos = 0;
+            worker.idleNanos = 0;
+            worker.parks = 0;
+        }
+    }
+
+    //----------------- PARALLEL FOR -----------------//
+
+    struct ParallelForState final
+    {
+        alignas(64) std::atomic<int> next = 0; // Start of the next chunk
+        int count = 0;
+        int grainSize = 0;
+        int participants = 0;
+        internal::ParallelFunc invoke = nullptr;
+        void* func = nullptr;
+    };
+
+    // The main thread uses the index after the workers - other threads never run chunks of other threads (see help())
+    static int GetThreadIndex() { return WORKER_INDEX >= 0 ? WORKER_INDEX : global::SCHEDULER.threadCount; }
+
+    static void RunChunks(ParallelForState& state)
+    {
+        const int thread = GetThreadIndex();
         while (true)
         {
-            SpinLockGuard guard{scd.queueLock};
-            SpinLockGuard guard2{scd.workedLock};
-            if (scd.queuedJobs.empty() && scd.workedJobs.empty())
+            // Guided chunking - big chunks first and smaller ones at the end
+            const int remaining = state.count - state.next.load(std::memory_order_relaxed);
+            if (remaining <= 0)
                 return;
-            else
-                std::this_thread::yield();
+            const int chunk = std::max(state.grainSize, remaining / (2 * state.participants));
+            const int start = state.next.fetch_add(chunk, std::memory_order_relaxed);
+            if (start >= state.count)
+                return;
+            state.invoke(state.func, thread, start, std::min(start + chunk, state.count));
+        }
+    }
+
+    //----------------- JOB GRAPH -----------------//
+
+    int JobGraph::add(const std::function<void()>& func, const std::initializer_list<int> dependencies)
+    {
+        const int index = static_cast<int>(nodes.size());
+        Node node{func, static_cast<int>(this->dependencies.size()), 0};
+        for (const int dependency : dependencies)
+        {
+            if (dependency < 0 || dependency >= index) [[unlikely]]
+            {
+                LOG_WARNING("Invalid dependency %d for node %d - must be a previously added node", dependency, index);
+                continue;
+            }
+            this->dependencies.push_back(dependency);
+            ++node.depCount;
+        }
+        nodes.push_back(std::move(node));
+        return index;
+    }
+
+    void JobGraph::run()
+    {
+        if (isRunning()) [[unlikely]]
+        {
+            LOG_WARNING("Graph is still running - awaiting the last run");
+            await();
         }
+        handles.resize(nodes.size()); // Only allocates after nodes were added
+        dependencyJobs.resize(dependencies.size());
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            const auto& node = nodes[i];
+            const auto* func = &node.func;
+            // Nodes only depend on previous nodes - their handles are already assigned
+            for (int j = node.depStart; j < node.depStart + node.depCount; ++j)
+            {
+                dependencyJobs[j] = handles[dependencies[j]];
+            }
+            const std::span<const JobID> waitFor{dependencyJobs.data() + node.depStart,
+                                                 static_cast<size_t>(node.depCount)};
+            handles[i] = JobAddAfter(waitFor, [func]() { (*func)(); }); // Stored in the job memory - no allocation
+        }
+    }
+
+    void JobGraph::await() const { JobAwait(handles); }
+
+    bool JobGraph::isRunning() const
+    {
+        const auto& scd = global::SCHEDULER;
+        return std::ranges::any_of(handles, [&](const JobID id) { return scd.isPending(id); });
     }
 
+    void JobGraph::clear()
+    {
+        await();
+        nodes.clear();
+        dependencies.clear();
+        dependencyJobs.clear();
+        handles.clear();
+    }
+
+    int JobGraph::getSize() const { return static_cast<int>(nodes.size()); }
+
     namespace internal
     {
         bool JobsInit()
@@ -74,10 +194,10 @@ namespace magique
             auto& scd = global::SCHEDULER;
             scd.shutDown = false;
             scd.isHibernate = true;
-            for (int i = 0; i < MAGIQUE_WORKER_THREADS; ++i)
-            {
-                scd.threads.emplace_back(JobData::WorkerThreadFunc, &global::SCHEDULER);
-            }
+            int count = scd.requestedThreads;
+            if (count < 0) // One core is left for the main thread
+                count = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+            scd.init(count, scd.pinThreads);
             return true;
         }
 
@@ -90,29 +210,122 @@ namespace magique
         void JobsWakeUp()
         {
             auto& scd = global::SCHEDULER;
+            if (!scd.isHibernate.load(std::memory_order_relaxed))
+                return;
             scd.isHibernate = false;
+            scd.wakeAll();
         }
 
-        void JobsSleep(const double target, const double sleepTime)
+        void JobsSleep()
         {
             auto& scd = global::SCHEDULER;
-            scd.targetTime = target;
-            scd.sleepTime = sleepTime;
             scd.isHibernate = true;
         }
 
         JobID JobQueue(IJob* job, float delay)
         {
             auto& scd = global::SCHEDULER;
-            SpinLockGuard guard{scd.queueLock};
-            const auto handle = static_cast<JobID>(scd.handleID++);
-            job->id = handle;
             job->execTime = EngineGetTime() + delay;
-            scd.queuedJobs.push_back(job);
+            scd.track(job);
+            const auto handle = job->id; // Job can be done as soon as it's submitted
+            if (delay > 0.0F)
+                scd.schedule(job);
+            else
+                scd.submit(job);
             return handle;
         }
+
+        void JobParallelForImpl(const int count, int grainSize, const ParallelFunc invoke, void* func)
+        {
+            grainSize = std::max(grainSize, 1);
+            if (count <= 0) [[unlikely]]
+                return;
+            const int threads = global::SCHEDULER.threadCount;
+            if (count <= grainSize || threads == 0)
+            {
+                invoke(func, GetThreadIndex(), 0, count);
+                return;
+            }
+
+            ParallelForState state;
+            state.count = count;
+            state.grainSize = grainSize;
+            state.invoke = invoke;
+            state.func = func;
+            // Only as many helpers as there are chunks of the grain size
+            const int helpers = std::min(threads, (count - 1) / grainSize);
+            state.participants = helpers + 1;
+
+            std::vector<JobID> handles(helpers);
+            for (auto& handle : handles)
+            {
+                handle = JobAdd([&state]() { RunChunks(state); });
+            }
+            RunChunks(state); // Calling thread takes part
+            JobAwait(handles);
+        }
+
+        JobID JobQueueMainThread(IJob* job, const PriorityLevel priority)
+        {
+            auto& scd = global::SCHEDULER;
+            job->execTime = EngineGetTime();
+            scd.track(job);
+            const auto handle = job->id;
+            scd.addMain(job, priority);
+            return handle;
+        }
+
+        JobID JobQueueAfter(IJob* job, const std::span<const JobID> dependencies)
+        {
+            auto& scd = global::SCHEDULER;
+            job->execTime = EngineGetTime();
+            job->waitCount.store(1, std::memory_order_relaxed); // Held until all dependencies are registered
+            scd.track(job);
+            const auto handle = job->id;
+            for (const auto dependency : dependencies)
+            {
+                if (dependency != JobID::null && dependency != handle)
+                    scd.addContinuation(dependency, job);
+            }
+            scd.release(job);
+            return handle;
+        }
+
+        //----------------- TASKS -----------------//
+
+        void* JobAllocateFrame(const size_t bytes) { return global::SCHEDULER.framePool.allocate(bytes); }
+
+        void JobFreeFrame(void* frame, const size_t bytes) { global::SCHEDULER.framePool.free(frame, bytes); }
+
+        bool JobIsMainThread() { return std::this_thread::get_id() == global::SCHEDULER.mainThread; }
+
+        bool JobIsWorkerThread() { return WORKER_INDEX >= 0; }
+
+        bool JobIsPending(const JobID id) { return global::SCHEDULER.isPending(id); }
+
+        void JobResumeAfter(const JobID id, const std::coroutine_handle<> handle)
+        {
+            JobAddAfter(id, [handle]() { handle.resume(); });
+        }
+
+        void JobResumeOnWorker(const std::coroutine_handle<> handle)
+        {
+            JobAdd([handle]() { handle.resume(); });
+        }
+
+        void JobResumeOnMainThread(const std::coroutine_handle<> handle)
+        {
+            auto& scd = global::SCHEDULER;
+            scd.queueResume(scd.mainResumes, handle);
+        }
+
+        void JobResumeNextTick(const std::coroutine_handle<> handle)
+        {
+            auto& scd = global::SCHEDULER;
+            scd.queueResume(scd.tickResumes, handle);
+        }
     } // namespace internal
 
-    void* internal::JobGetJobMemory(const size_t bytes) { return global::SCHEDULER.jobAllocator.allocate(bytes); }
+    void* internal::JobGetJobMemory(const size_t bytes) { return global::SCHEDULER.allocate(bytes); }
 
 } // namespace magique
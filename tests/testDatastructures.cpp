@@ -0,0 +1,149 @@
+#include <catch_amalgamated.hpp>
+#include <random>
+#include <vector>
+#include <magique/util/Datastructures.h>
+
+using namespace magique;
+
+namespace
+{
+    struct QueueNode final
+    {
+        uint32_t key;
+        uint32_t value;
+        bool operator>(const QueueNode& o) const { return key > o.key; }
+    };
+
+    // Simulates the open list of a search - popped keys increase while pushed keys are close to the popped one
+    std::vector<uint32_t> MakeMonotoneKeys(const int count)
+    {
+        std::mt19937 rng(42);
+        std::vector<uint32_t> keys;
+        keys.reserve(count);
+        uint32_t base = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            base += rng() % 4;
+            keys.push_back(base + (rng() % 256));
+        }
+        return keys;
+    }
+} // namespace
+
+TEST_CASE("RadixHeap returns elements in key order")
+{
+    RadixHeap<uint32_t> heap;
+    REQUIRE(heap.empty());
+
+    SECTION("Random keys pushed upfront")
+    {
+        std::mt19937 rng(7);
+        std::vector<uint32_t> keys(1000);
+        for (auto& key : keys)
+        {
+            key = rng() % 100'000;
+            heap.push(key, key);
+        }
+        std::ranges::sort(keys);
+        REQUIRE(heap.size() == keys.size());
+        for (const auto key : keys)
+        {
+            REQUIRE(heap.topKey() == key);
+            REQUIRE(heap.top() == key);
+            heap.pop();
+        }
+        REQUIRE(heap.empty());
+    }
+
+    SECTION("Interleaved push and pop")
+    {
+        PriorityQueue<QueueNode> reference;
+        for (const auto key : MakeMonotoneKeys(2000))
+        {
+            // Keep keys monotone relative to the last popped key
+            const auto clamped = reference.empty() ? key : std::max(key, reference.top().key);
+            heap.push(clamped, clamped);
+            reference.push({clamped, clamped});
+            if (key % 3 == 0)
+            {
+                REQUIRE(heap.topKey() == reference.top().key);
+                heap.pop();
+                reference.pop();
+            }
+        }
+        while (!reference.empty())
+        {
+            REQUIRE(heap.topKey() == reference.top().key);
+            heap.pop();
+            reference.pop();
+        }
+        REQUIRE(heap.empty());
+    }
+
+    SECTION("Keys below the last popped key are clamped")
+    {
+        heap.push(10, 1);
+        heap.push(20, 2);
+        heap.pop();
+        heap.push(5, 3);
+        REQUIRE(heap.topKey() == 10);
+        REQUIRE(heap.top() == 3);
+    }
+
+    SECTION("Clear resets the bound")
+    {
+        heap.push(100, 1);
+        heap.pop();
+        heap.clear();
+        heap.push(1, 2);
+        REQUIRE(heap.topKey() == 1);
+    }
+}
+
+// Run with: magique-tests "[benchmark]"
+TEST_CASE("RadixHeap vs PriorityQueue", "[.][benchmark]")
+{
+    const auto keys = MakeMonotoneKeys(100'000);
+
+    BENCHMARK("PriorityQueue")
+    {
+        PriorityQueue<QueueNode> queue{keys.size()};
+        uint64_t sum = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            queue.push({keys[i], static_cast<uint32_t>(i)});
+            if (i % 2 == 0)
+            {
+                sum += queue.top().value;
+                queue.pop();
+            }
+        }
+        while (!queue.empty())
+        {
+            sum += queue.top().value;
+            queue.pop();
+        }
+        return sum;
+    };
+
+    BENCHMARK("RadixHeap")
+    {
+        RadixHeap<uint32_t> heap{keys.size()};
+        uint64_t sum = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            heap.push(keys[i], static_cast<uint32_t>(i));
+            if (i % 2 == 0)
+            {
+                sum += heap.top();
+                heap.pop();
+            }
+        }
+        while (!heap.empty())
+        {
+            sum += heap.top();
+            heap.pop();
+        }
+        return sum;
+    };
+}
@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+
+#include <catch_amalgamated.hpp>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <magique/util/JobSystem.h>
+#include <magique/util/JobTask.h>
+
+#include "internal/globals/EngineData.h"
+#include "internal/globals/JobData.h"
+
+using namespace magique;
+
+namespace
+{
+    // The tests share one job system - skipped if another test already initialized it
+    void InitJobs()
+    {
+        JobSetWorkerCount(2);
+        internal::JobsInit();
+        internal::JobsWakeUp();
+    }
+
+    // Delayed jobs are due by engine time - the tests advance it by hand
+    void AdvanceTime(const float seconds) { global::ENGINE_DATA.engineTime += seconds; }
+
+    // Returns a job that stays pending until the time is advanced by the given seconds
+    JobID AddGate(const float delay) { return JobAdd([] {}, delay); }
+
+    uint32_t GetSlot(const JobID id) { return static_cast<uint32_t>(id) & UINT16_MAX; }
+
+    JobTask AwaitThenSwitch(const JobID id, std::atomic<int>& step)
+    {
+        step = 1;
+        co_await JobWaitFor(id);
+        step = 2;
+        co_await JobSwitchToWorker();
+        step = 3;
+    }
+} // namespace
+
+TEST_CASE("JobParallelFor runs every index exactly once")
+{
+    InitJobs();
+    constexpr int count = 10'000;
+    std::vector<std::atomic<int>> hits(count);
+    std::atomic<bool> validThread = true;
+
+    JobParallelFor(count, 16,
+                   [&](const int thread, const int start, const int end)
+                   {
+                       if (thread < 0 || thread >= JobGetThreadCount())
+                           validThread = false;
+                       for (int i = start; i < end; ++i)
+                           hits[i].fetch_add(1, std::memory_order_relaxed);
+                   });
+
+    REQUIRE(validThread);
+    for (const auto& hit : hits)
+        REQUIRE(hit.load() == 1);
+}
+
+TEST_CASE("Dependencies and continuations run in order")
+{
+    InitJobs();
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](const int value)
+    {
+        std::lock_guard lock{orderMutex};
+        order.push_back(value);
+    };
+
+    SECTION("Continuation chain")
+    {
+        const auto gate = AddGate(1.0F);
+        const auto first = JobAddAfter(gate, [&] { record(1); });
+        const auto second = JobAddAfter(first, [&] { record(2); });
+        const auto third = JobAddAfter(second, [&] { record(3); });
+        REQUIRE(internal::JobIsPending(third));
+        AdvanceTime(1.0F);
+        JobAwait(third);
+        REQUIRE(order == std::vector<int>{1, 2, 3});
+    }
+
+    SECTION("Job after multiple dependencies")
+    {
+        std::atomic<int> done = 0;
+        std::vector<JobID> dependencies;
+        for (int i = 0; i < 64; ++i)
+            dependencies.push_back(JobAdd([&] { done.fetch_add(1); }));
+        std::atomic<int> seen = -1;
+        const auto after = JobAddAfter(dependencies, [&] { seen = done.load(); });
+        JobAwait(after);
+        REQUIRE(seen == 64);
+    }
+
+    SECTION("Dependency that is already done")
+    {
+        const auto first = JobAdd([&] { record(1); });
+        JobAwait(first);
+        REQUIRE_FALSE(internal::JobIsPending(first));
+        JobAwait(JobAddAfter(first, [&] { record(2); }));
+        REQUIRE(order == std::vector<int>{1, 2});
+    }
+}
+
+TEST_CASE("Stale job handles don't alias reused slots")
+{
+    InitJobs();
+    const auto gate = AddGate(1.0F); // Keeps the new jobs pending
+
+    // Main thread jobs run and free their slot on the calling thread - the next job from it reuses the slot
+    const auto stale = JobAddMainThread([] {}, CRITICAL);
+    JobAwait(stale);
+    REQUIRE_FALSE(internal::JobIsPending(stale));
+
+    std::atomic<int> executed = 0;
+    JobID reused = JobID::null;
+    for (int i = 0; i < 4096 && reused == JobID::null; ++i)
+    {
+        const auto id = JobAddAfter(gate, [&] { executed.fetch_add(1); });
+        if (GetSlot(id) == GetSlot(stale))
+            reused = id;
+    }
+
+    REQUIRE(reused != JobID::null);
+    REQUIRE(reused != stale);
+    REQUIRE(internal::JobIsPending(reused));
+    REQUIRE_FALSE(internal::JobIsPending(stale));
+    JobAwait(stale); // Returns immediately - doesn't wait for the new job
+    REQUIRE(internal::JobIsPending(reused));
+
+    AdvanceTime(1.0F);
+    JobAwait(reused);
+    JobAwaitAll();
+    REQUIRE(executed > 0);
+    REQUIRE_FALSE(internal::JobIsPending(reused));
+}
+
+TEST_CASE("Jobs added past the deque capacity overflow to the inbox")
+{
+    InitJobs();
+    constexpr int count = 3 * WorkStealingDeque::CAPACITY;
+    std::atomic<int> executed = 0;
+    std::atomic<bool> released = false;
+    std::atomic<int> overflowed = -1; // -1 if the spawner didn't run on a worker
+
+    const auto spawner = JobAdd(
+        [&]
+        {
+            std::vector<JobID> children;
+            children.reserve(count);
+            for (int i = 0; i < count; ++i)
+            {
+                // Stolen children block the thief until all are added - the deque of the spawner fills up
+                children.push_back(JobAdd(
+                    [&]
+                    {
+                        while (!released.load(std::memory_order_acquire))
+                            std::this_thread::yield();
+                        executed.fetch_add(1, std::memory_order_relaxed);
+                    }));
+            }
+            if (WORKER_INDEX >= 0)
+                overflowed = global::SCHEDULER.workers[WORKER_INDEX].inboxSize.load() > 0 ? 1 : 0;
+            released.store(true, std::memory_order_release);
+            JobAwait(children);
+        });
+    const bool hasWorkers = JobGetThreadCount() > 1;
+    if (hasWorkers) // Waits without helping - the spawner has to run on a worker to push into its deque
+    {
+        while (internal::JobIsPending(spawner))
+            std::this_thread::yield();
+    }
+    else
+    {
+        JobAwait(spawner);
+    }
+
+    REQUIRE(overflowed == (hasWorkers ? 1 : -1));
+    REQUIRE(executed == count);
+}
+
+TEST_CASE("Delayed jobs fire once they are due")
+{
+    InitJobs();
+    std::atomic<bool> fired = false;
+    const auto id = JobAdd([&] { fired = true; }, 0.5F);
+
+    AdvanceTime(0.25F);
+    JobAwait(JobAdd([] {})); // Gives the scheduler a chance to release it early
+    REQUIRE(internal::JobIsPending(id));
+    REQUIRE_FALSE(fired);
+
+    AdvanceTime(0.25F);
+    JobAwait(id);
+    REQUIRE(fired);
+}
+
+TEST_CASE("JobTask resumes after co_await")
+{
+    InitJobs();
+    std::atomic<int> step = 0;
+    const auto gate = AddGate(1.0F);
+    const JobTask task = AwaitThenSwitch(gate, step);
+
+    // Runs until the first await on the calling thread
+    REQUIRE(step == 1);
+    REQUIRE_FALSE(task.isDone());
+
+    AdvanceTime(1.0F);
+    JobAwait(gate);
+    JobAwaitAll(); // The resumptions are jobs as well
+
+    REQUIRE(step == 3);
+    REQUIRE(task.isDone());
+}